@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "accesspointranking.h"
+
+namespace dde {
+
+namespace network {
+
+AccessPointRanking::AccessPointRanking()
+    : m_root(nullptr)
+{
+}
+
+AccessPointRanking::~AccessPointRanking()
+{
+    destroy(m_root);
+}
+
+int AccessPointRanking::insert(const QString &path, const QString &ssid, int strength, bool known)
+{
+    const auto it = m_entries.constFind(path);
+    if (it != m_entries.constEnd()) {
+        // 排序相关的字段没有变化时位置不变
+        if (it->ssid == ssid && it->strength == strength && it->known == known)
+            return rankOf(it.value());
+
+        m_root = erase(m_root, it.value());
+    }
+
+    const Entry entry { path, ssid, strength, known };
+    m_entries.insert(path, entry);
+
+    Node *node = new Node { entry, unsigned(m_random()), 1, nullptr, nullptr };
+    Node *left = nullptr;
+    Node *right = nullptr;
+    split(m_root, entry, left, right);
+
+    // 合并后 left 的大小会变化, 需要提前记录
+    const int row = sizeOf(left);
+    m_root = merge(merge(left, node), right);
+
+    return row;
+}
+
+int AccessPointRanking::remove(const QString &path)
+{
+    const auto it = m_entries.find(path);
+    if (it == m_entries.end())
+        return -1;
+
+    const int row = rankOf(it.value());
+    m_root = erase(m_root, it.value());
+    m_entries.erase(it);
+
+    return row;
+}
+
+void AccessPointRanking::clear()
+{
+    destroy(m_root);
+    m_root = nullptr;
+    m_entries.clear();
+}
+
+int AccessPointRanking::indexOf(const QString &path) const
+{
+    const auto it = m_entries.constFind(path);
+    return it == m_entries.constEnd() ? -1 : rankOf(it.value());
+}
+
+QString AccessPointRanking::pathAt(int row) const
+{
+    const Node *node = m_root;
+    while (node) {
+        const int leftSize = sizeOf(node->left);
+        if (row < leftSize) {
+            node = node->left;
+        } else if (row == leftSize) {
+            return node->entry.path;
+        } else {
+            row -= leftSize + 1;
+            node = node->right;
+        }
+    }
+
+    return QString();
+}
+
+QStringList AccessPointRanking::paths() const
+{
+    QStringList paths;
+    paths.reserve(size());
+
+    // 中序遍历
+    QList<const Node *> stack;
+    const Node *node = m_root;
+    while (node || !stack.isEmpty()) {
+        while (node) {
+            stack.append(node);
+            node = node->left;
+        }
+        node = stack.takeLast();
+        paths.append(node->entry.path);
+        node = node->right;
+    }
+
+    return paths;
+}
+
+bool AccessPointRanking::lessThan(const Entry &e1, const Entry &e2)
+{
+    if (e1.known != e2.known)
+        return e1.known;
+    if (e1.strength != e2.strength)
+        return e1.strength > e2.strength;
+    if (e1.ssid != e2.ssid)
+        return e1.ssid < e2.ssid;
+
+    // 同名同强度时按路径区分, 保证顺序稳定
+    return e1.path < e2.path;
+}
+
+void AccessPointRanking::updateSize(Node *node)
+{
+    node->size = 1 + sizeOf(node->left) + sizeOf(node->right);
+}
+
+void AccessPointRanking::split(Node *node, const Entry &entry, Node *&left, Node *&right)
+{
+    if (!node) {
+        left = right = nullptr;
+        return;
+    }
+
+    if (lessThan(node->entry, entry)) {
+        split(node->right, entry, node->right, right);
+        left = node;
+    } else {
+        split(node->left, entry, left, node->left);
+        right = node;
+    }
+    updateSize(node);
+}
+
+AccessPointRanking::Node *AccessPointRanking::merge(Node *left, Node *right)
+{
+    if (!left)
+        return right;
+    if (!right)
+        return left;
+
+    if (left->priority > right->priority) {
+        left->right = merge(left->right, right);
+        updateSize(left);
+        return left;
+    }
+
+    right->left = merge(left, right->left);
+    updateSize(right);
+    return right;
+}
+
+AccessPointRanking::Node *AccessPointRanking::erase(Node *node, const Entry &entry)
+{
+    if (!node)
+        return nullptr;
+
+    if (lessThan(entry, node->entry)) {
+        node->left = erase(node->left, entry);
+    } else if (lessThan(node->entry, entry)) {
+        node->right = erase(node->right, entry);
+    } else {
+        Node *merged = merge(node->left, node->right);
+        delete node;
+        return merged;
+    }
+
+    updateSize(node);
+    return node;
+}
+
+void AccessPointRanking::destroy(Node *node)
+{
+    if (!node)
+        return;
+
+    destroy(node->left);
+    destroy(node->right);
+    delete node;
+}
+
+int AccessPointRanking::rankOf(const Entry &entry) const
+{
+    int rank = 0;
+    const Node *node = m_root;
+    while (node) {
+        if (lessThan(node->entry, entry)) {
+            rank += sizeOf(node->left) + 1;
+            node = node->right;
+        } else if (lessThan(entry, node->entry)) {
+            node = node->left;
+        } else {
+            return rank + sizeOf(node->left);
+        }
+    }
+
+    return -1;
+}
+
+}   // namespace network
+
+}   // namespace dde
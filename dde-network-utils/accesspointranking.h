@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ACCESSPOINTRANKING_H
+#define ACCESSPOINTRANKING_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <random>
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief AccessPointRanking 按 已保存的网络 > 信号强度 > SSID 的顺序维护 AP 的排名,
+ * 内部是一棵带子树大小的 treap, 插入、删除、查询排名和按位置取值都是 O(log n)
+ */
+class AccessPointRanking
+{
+public:
+    AccessPointRanking();
+    ~AccessPointRanking();
+
+    inline int size() const { return m_entries.size(); }
+    inline bool contains(const QString &path) const { return m_entries.contains(path); }
+
+    /**
+     * @brief insert 插入或更新一个 AP, 返回其更新后的位置
+     */
+    int insert(const QString &path, const QString &ssid, int strength, bool known);
+    /**
+     * @brief remove 移除一个 AP, 返回其移除前的位置, 不存在时返回 -1
+     */
+    int remove(const QString &path);
+    void clear();
+
+    int indexOf(const QString &path) const;
+    QString pathAt(int row) const;
+    QStringList paths() const;
+
+private:
+    struct Entry
+    {
+        QString path;
+        QString ssid;
+        int strength;
+        bool known;
+    };
+
+    struct Node
+    {
+        Entry entry;
+        unsigned priority;
+        int size;
+        Node *left;
+        Node *right;
+    };
+
+    static bool lessThan(const Entry &e1, const Entry &e2);
+    static inline int sizeOf(const Node *node) { return node ? node->size : 0; }
+    static void updateSize(Node *node);
+    static void split(Node *node, const Entry &entry, Node *&left, Node *&right);
+    static Node *merge(Node *left, Node *right);
+    static Node *erase(Node *node, const Entry &entry);
+    static void destroy(Node *node);
+    int rankOf(const Entry &entry) const;
+
+private:
+    Q_DISABLE_COPY(AccessPointRanking)
+
+    Node *m_root;
+    QHash<QString, Entry> m_entries;
+    std::minstd_rand m_random;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // ACCESSPOINTRANKING_H
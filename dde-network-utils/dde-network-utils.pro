@@ -8,20 +8,34 @@ PKGCONFIG += dframeworkdbus gsettings-qt
 DEFINES += DDENETWORKUTILS_LIBRARY QT_DEPRECATED_WARNINGS
 
 SOURCES += \
+    $$PWD/accesspointranking.cpp \
     $$PWD/networkmodel.cpp \
     $$PWD/networkworker.cpp \
     $$PWD/networkdevice.cpp \
     $$PWD/wirelessdevice.cpp \
     $$PWD/wireddevice.cpp \
-    $$PWD/connectivitychecker.cpp
+    $$PWD/connectivitychecker.cpp \
+    $$PWD/networkrecord.cpp \
+    $$PWD/networksnapshot.cpp \
+    $$PWD/payloadparser.cpp \
+    $$PWD/wirelessscanscheduler.cpp \
+    $$PWD/networkcache.cpp \
+    $$PWD/latencyhistogram.cpp
 
 HEADERS += \
+    $$PWD/accesspointranking.h \
     $$PWD/networkmodel.h \
     $$PWD/networkworker.h \
     $$PWD/networkdevice.h \
     $$PWD/wirelessdevice.h \
     $$PWD/wireddevice.h \
-    $$PWD/connectivitychecker.h
+    $$PWD/connectivitychecker.h \
+    $$PWD/networkrecord.h \
+    $$PWD/networksnapshot.h \
+    $$PWD/payloadparser.h \
+    $$PWD/wirelessscanscheduler.h \
+    $$PWD/networkcache.h \
+    $$PWD/latencyhistogram.h
 
 includes.files += *.h
 includes.files += \
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "latencyhistogram.h"
+
+#include <cmath>
+
+namespace dde {
+
+namespace network {
+
+static int bucketIndex(qint64 msec)
+{
+    int index = 0;
+    while (msec > 1 && index < LatencyHistogram::BucketCount - 1) {
+        msec >>= 1;
+        ++index;
+    }
+
+    return index;
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    clear();
+}
+
+void LatencyHistogram::add(qint64 msec)
+{
+    msec = qMax(qint64(0), msec);
+
+    ++m_buckets[bucketIndex(msec)];
+    m_min = m_count ? qMin(m_min, msec) : msec;
+    m_max = m_count ? qMax(m_max, msec) : msec;
+    m_total += msec;
+    ++m_count;
+}
+
+void LatencyHistogram::clear()
+{
+    for (int &bucket : m_buckets)
+        bucket = 0;
+
+    m_count = 0;
+    m_total = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+qint64 LatencyHistogram::percentile(double p) const
+{
+    if (m_count == 0)
+        return 0;
+
+    const int rank = qMax(1, int(std::ceil(qBound(0.0, p, 1.0) * m_count)));
+    int seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank)
+            return i == BucketCount - 1 ? m_max : qMin(bucketUpperBound(i), m_max);
+    }
+
+    return m_max;
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    return qint64(1) << (index + 1);
+}
+
+}   // namespace network
+
+}   // namespace dde
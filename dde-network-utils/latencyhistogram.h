@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief LatencyHistogram 以 2 的幂为区间统计耗时(毫秒), 第 i 个区间为 [2^i, 2^(i+1)),
+ * 第 0 个区间包含 0 和 1, 最后一个区间包含所有更大的值
+ */
+class LatencyHistogram
+{
+public:
+    enum { BucketCount = 18 };
+
+    LatencyHistogram();
+
+    void add(qint64 msec);
+    void clear();
+
+    inline int count() const { return m_count; }
+    inline qint64 min() const { return m_min; }
+    inline qint64 max() const { return m_max; }
+    inline qint64 mean() const { return m_count ? m_total / m_count : 0; }
+    inline int bucket(int index) const { return m_buckets[index]; }
+    /**
+     * @brief percentile 近似的分位数, 返回所在区间的上界(不超过最大值), p 的范围为 0 到 1
+     */
+    qint64 percentile(double p) const;
+
+    static qint64 bucketUpperBound(int index);
+
+private:
+    int m_buckets[BucketCount];
+    int m_count;
+    qint64 m_total;
+    qint64 m_min;
+    qint64 m_max;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // LATENCYHISTOGRAM_H
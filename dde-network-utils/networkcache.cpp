@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "networkcache.h"
+
+#include <QDir>
+#include <QDebug>
+#include <QTimer>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QtEndian>
+
+#define CacheMagic 0x43554e44   // "DNUC"
+#define CacheVersion 1
+// 数据变化后延迟写入磁盘的时间
+#define CacheSaveDelay 2000
+
+namespace dde {
+
+namespace network {
+
+static void appendUInt32(QByteArray &data, quint32 value)
+{
+    value = qToLittleEndian(value);
+    data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static bool readUInt32(const uchar *&pos, const uchar *end, quint32 &value)
+{
+    if (end - pos < qint64(sizeof(quint32)))
+        return false;
+
+    value = qFromLittleEndian<quint32>(pos);
+    pos += sizeof(quint32);
+
+    return true;
+}
+
+NetworkCache::NetworkCache(const QString &fileName, QObject *parent)
+    : QObject(parent)
+    , m_file(fileName)
+    , m_map(nullptr)
+    , m_saveTimer(new QTimer(this))
+{
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(CacheSaveDelay);
+    connect(m_saveTimer, &QTimer::timeout, this, &NetworkCache::save);
+}
+
+NetworkCache::~NetworkCache()
+{
+    if (m_saveTimer->isActive())
+        save();
+
+    // 先释放指向映射内存的数据再解除映射
+    for (QByteArray &payload : m_payloads)
+        payload.clear();
+
+    if (m_map)
+        m_file.unmap(m_map);
+}
+
+QString NetworkCache::defaultFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/dde-network-utils/network.cache";
+}
+
+bool NetworkCache::isCached(NetworkSnapshot::PayloadType type)
+{
+    // 活动连接的状态变化很快, 缓存中的旧状态反而会误导用户
+    return type == NetworkSnapshot::DevicesPayload ||
+           type == NetworkSnapshot::ConnectionsPayload ||
+           type == NetworkSnapshot::AccessPointsPayload;
+}
+
+bool NetworkCache::load()
+{
+    if (m_map || !m_file.exists() || !m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 size = m_file.size();
+    // 映射在 m_file 销毁时才会解除, 文件在此之前保持打开
+    m_map = size > 0 ? m_file.map(0, size) : nullptr;
+    if (!m_map)
+        return false;
+
+    const uchar *pos = m_map;
+    const uchar *end = m_map + size;
+    quint32 magic = 0, version = 0, count = 0;
+    if (!readUInt32(pos, end, magic) || !readUInt32(pos, end, version) || !readUInt32(pos, end, count) ||
+            magic != CacheMagic || version != CacheVersion) {
+        qWarning() << "ignore invalid network cache" << fileName();
+        return false;
+    }
+
+    QByteArray payloads[NetworkSnapshot::PayloadTypeCount];
+    for (quint32 i = 0; i < count; ++i) {
+        quint32 type = 0, length = 0;
+        if (!readUInt32(pos, end, type) || !readUInt32(pos, end, length) || end - pos < qint64(length)) {
+            qWarning() << "network cache is truncated" << fileName();
+            return false;
+        }
+
+        if (type < NetworkSnapshot::PayloadTypeCount)
+            payloads[type] = QByteArray::fromRawData(reinterpret_cast<const char *>(pos), int(length));
+        pos += length;
+    }
+
+    for (int type = 0; type < NetworkSnapshot::PayloadTypeCount; ++type) {
+        if (m_payloads[type].isEmpty())
+            m_payloads[type] = payloads[type];
+    }
+
+    return true;
+}
+
+bool NetworkCache::save()
+{
+    m_saveTimer->stop();
+
+    QByteArray data;
+    quint32 count = 0;
+    for (const QByteArray &payload : m_payloads)
+        count += !payload.isEmpty();
+
+    appendUInt32(data, CacheMagic);
+    appendUInt32(data, CacheVersion);
+    appendUInt32(data, count);
+    for (int type = 0; type < NetworkSnapshot::PayloadTypeCount; ++type) {
+        const QByteArray &payload = m_payloads[type];
+        if (payload.isEmpty())
+            continue;
+
+        appendUInt32(data, quint32(type));
+        appendUInt32(data, quint32(payload.size()));
+        data.append(payload);
+    }
+
+    QDir().mkpath(QFileInfo(fileName()).absolutePath());
+
+    // 先写临时文件再替换, 已映射的旧文件内容不受影响
+    QSaveFile file(fileName());
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "failed to save network cache" << fileName() << file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+void NetworkCache::store(NetworkSnapshot::PayloadType type, const QByteArray &payload)
+{
+    if (!isCached(type) || m_payloads[type] == payload)
+        return;
+
+    m_payloads[type] = payload;
+
+    if (!m_saveTimer->isActive())
+        m_saveTimer->start();
+}
+
+}   // namespace network
+
+}   // namespace dde
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NETWORKCACHE_H
+#define NETWORKCACHE_H
+
+#include "networksnapshot.h"
+
+#include <QObject>
+#include <QFile>
+#include <QByteArray>
+
+class QTimer;
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief NetworkCache 将最近一次的设备列表、连接列表及 AP 列表原样保存在磁盘上,
+ * 启动时通过内存映射读取, 使界面在 DBus 数据返回之前就能显示上次的内容
+ *
+ * 文件格式(小端): 魔数, 版本, 数据段个数, 之后每段为 类型, 长度, 原始数据
+ */
+class NetworkCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NetworkCache(const QString &fileName = defaultFileName(), QObject *parent = nullptr);
+    ~NetworkCache() override;
+
+    static QString defaultFileName();
+    static bool isCached(NetworkSnapshot::PayloadType type);
+
+    inline QString fileName() const { return m_file.fileName(); }
+
+    bool load();
+    bool save();
+    // 返回的数据可能直接指向映射的文件内容, 在本对象销毁前有效
+    inline QByteArray payload(NetworkSnapshot::PayloadType type) const { return m_payloads[type]; }
+    // 记录新的数据, 短时间内的多次修改只会写一次磁盘
+    void store(NetworkSnapshot::PayloadType type, const QByteArray &payload);
+
+private:
+    QFile m_file;
+    uchar *m_map;
+    QByteArray m_payloads[NetworkSnapshot::PayloadTypeCount];
+    QTimer *m_saveTimer;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // NETWORKCACHE_H
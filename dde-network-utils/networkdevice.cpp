@@ -30,8 +30,7 @@
 #include <QJsonArray>
 #include <QJsonValue>
 #include <QJsonDocument>
-
-#define MaxQueueSize 4
+#include <QMetaMethod>
 
 using namespace dde::network;
 
@@ -40,9 +39,17 @@ NetworkDevice::NetworkDevice(const DeviceType type, const QJsonObject &info, QOb
 
       m_type(type),
       m_status(Unknown),
-      m_deviceInfo(info),
+      m_statusHead(0),
+      m_statusCount(0),
+      m_managed(false),
+      m_supportHotspot(false),
+      m_interfaceFlags(0),
       m_enabled(true)
 {
+    m_statusClock.start();
+    for (qint64 &started : m_phaseStarted)
+        started = -1;
+
     updateDeviceInfo(info);
 }
 
@@ -74,18 +81,99 @@ void NetworkDevice::setDeviceStatus(const int status)
 
         Q_EMIT statusChanged(m_status);
         Q_EMIT statusChanged(statusString());
-        Q_EMIT statusQueueChanged(m_statusQueue);
+
+        // 没有接收者时不必构造状态队列的副本
+        static const QMetaMethod queueChangedSignal = QMetaMethod::fromSignal(&NetworkDevice::statusQueueChanged);
+        if (isSignalConnected(queueChangedSignal))
+            Q_EMIT statusQueueChanged(statusQueue());
     }
 }
 
 // prepre-status, pre-status, now-status
 void NetworkDevice::enqueueStatus(NetworkDevice::DeviceStatus status)
 {
-    if (m_statusQueue.size() == MaxQueueSize) {
-        m_statusQueue.dequeue();
+    const qint64 now = m_statusClock.elapsed();
+
+    if (m_statusCount == MaxStatusHistory) {
+        m_statusRing[m_statusHead] = StatusEntry { status, now };
+        m_statusHead = (m_statusHead + 1) % MaxStatusHistory;
+    } else {
+        m_statusRing[(m_statusHead + m_statusCount) % MaxStatusHistory] = StatusEntry { status, now };
+        ++m_statusCount;
+    }
+
+    recordPhase(status, now);
+}
+
+void NetworkDevice::recordPhase(DeviceStatus status, qint64 timestamp)
+{
+    switch (status) {
+    case Prepare:
+        m_phaseStarted[PreparePhase] = timestamp;
+        m_phaseStarted[ConfigPhase] = -1;
+        m_phaseStarted[IpConfigPhase] = -1;
+        break;
+    case Config:
+        if (m_phaseStarted[PreparePhase] >= 0 && m_phaseStarted[ConfigPhase] < 0) {
+            m_phaseLatency[PreparePhase].add(timestamp - m_phaseStarted[PreparePhase]);
+            m_phaseStarted[ConfigPhase] = timestamp;
+        }
+        break;
+    case IpConfig:
+        // 认证(NeedAuth)的时间计入 Config 阶段
+        if (m_phaseStarted[ConfigPhase] >= 0 && m_phaseStarted[IpConfigPhase] < 0) {
+            m_phaseLatency[ConfigPhase].add(timestamp - m_phaseStarted[ConfigPhase]);
+            m_phaseStarted[IpConfigPhase] = timestamp;
+        }
+        break;
+    case Activated:
+        if (m_phaseStarted[IpConfigPhase] >= 0)
+            m_phaseLatency[IpConfigPhase].add(timestamp - m_phaseStarted[IpConfigPhase]);
+        for (qint64 &started : m_phaseStarted)
+            started = -1;
+        break;
+    case Failed:
+        if (m_phaseStarted[PreparePhase] >= 0)
+            m_phaseLatency[FailurePhase].add(timestamp - m_phaseStarted[PreparePhase]);
+        for (qint64 &started : m_phaseStarted)
+            started = -1;
+        break;
+    default:
+        break;
     }
+}
 
-    m_statusQueue.enqueue(status);
+QQueue<NetworkDevice::DeviceStatus> NetworkDevice::statusQueue() const
+{
+    QQueue<DeviceStatus> queue;
+    for (int i = 0; i < m_statusCount; ++i)
+        queue.enqueue(statusAt(i));
+
+    return queue;
+}
+
+QList<NetworkDevice::StatusEntry> NetworkDevice::statusHistory() const
+{
+    QList<StatusEntry> history;
+    for (int i = 0; i < m_statusCount; ++i)
+        history.append(m_statusRing[(m_statusHead + i) % MaxStatusHistory]);
+
+    return history;
+}
+
+NetworkDevice::DeviceStatus NetworkDevice::statusAt(int index) const
+{
+    return m_statusRing[(m_statusHead + index) % MaxStatusHistory].status;
+}
+
+bool NetworkDevice::statusHistoryContains(DeviceStatus status) const
+{
+    for (int i = 0; i < m_statusCount; ++i) {
+        if (statusAt(i) == status)
+            return true;
+    }
+
+    return false;
 }
 
 const QString NetworkDevice::statusString() const
@@ -162,48 +250,87 @@ NetworkDevice::~NetworkDevice()
 
 bool NetworkDevice::obtainIpFailed() const
 {
-    if (m_statusQueue.isEmpty()) {
+    if (m_statusCount == 0) {
         return false;
     }
 
     // 判断为获取IP地址失败需要以下条件
-    return (m_statusQueue.size() == MaxQueueSize
-            && m_statusQueue.at(MaxQueueSize - 1) == DeviceStatus::Disconnected // 最后(当前)一个状态为未连接
-            && m_statusQueue.at(MaxQueueSize - 2) == DeviceStatus::Failed // 上一个状态为失败
-            && m_statusQueue.contains(DeviceStatus::Config) // 包含Config和IpConfig
-            && m_statusQueue.contains(DeviceStatus::IpConfig));
+    return (m_statusCount == MaxStatusHistory
+            && statusAt(MaxStatusHistory - 1) == DeviceStatus::Disconnected // 最后(当前)一个状态为未连接
+            && statusAt(MaxStatusHistory - 2) == DeviceStatus::Failed // 上一个状态为失败
+            && statusHistoryContains(DeviceStatus::Config) // 包含Config和IpConfig
+            && statusHistoryContains(DeviceStatus::IpConfig));
 }
 
 void NetworkDevice::setEnabled(const bool enabled)
 {
     if (m_enabled != enabled) {
         m_enabled = enabled;
-        m_statusQueue.clear();
+        m_statusHead = 0;
+        m_statusCount = 0;
         Q_EMIT enableChanged(m_enabled);
     }
 }
 
-const QString NetworkDevice::path() const
+// 内容相同时保留原来的字符串, 避免已经共享出去的数据被替换, 返回是否发生了变化
+static bool assignString(QString &dest, const QJsonValue &value)
 {
-    return m_deviceInfo.value("Path").toString();
-}
+    const QString &str = value.toString();
+    if (dest == str)
+        return false;
 
-const QString NetworkDevice::realHwAdr() const
-{
-    return m_deviceInfo.value("HwAddress").toString();
+    dest = str;
+    return true;
 }
 
-const QString NetworkDevice::usingHwAdr() const
+template <typename T>
+static bool assignValue(T &dest, const T &value)
 {
-    const auto &hwAdr = m_deviceInfo.value("HwAddress").toString();
-    const auto &clonedAdr = m_deviceInfo.value("ClonedAddress").toString();
+    if (dest == value)
+        return false;
 
-    return clonedAdr.isEmpty() ? hwAdr : clonedAdr;
+    dest = value;
+    return true;
 }
 
 void NetworkDevice::updateDeviceInfo(const QJsonObject &devInfo)
 {
+    // 设备信息没有变化时直接返回, 不产生任何拷贝和信号.
+    // 状态可能在本地被修改过(如激活失败), 后端重新发送相同的状态时仍以后端为准
+    if (m_deviceInfo == devInfo) {
+        setDeviceStatus(m_deviceInfo.value("State").toInt());
+        return;
+    }
+
+    const int oldState = m_deviceInfo.value("State").toInt();
     m_deviceInfo = devInfo;
 
-    setDeviceStatus(m_deviceInfo.value("State").toInt());
+    // 这些字段在 model 的循环中被频繁读取, 解析一次后缓存下来
+    ChangedFields fields;
+    if (assignString(m_path, m_deviceInfo.value("Path")))
+        fields |= PathField;
+    if (assignString(m_hwAddress, m_deviceInfo.value("HwAddress")))
+        fields |= HwAddressField;
+    if (assignString(m_clonedAddress, m_deviceInfo.value("ClonedAddress")))
+        fields |= ClonedAddressField;
+    if (assignString(m_interface, m_deviceInfo.value("Interface")))
+        fields |= InterfaceField;
+    if (assignValue(m_managed, m_deviceInfo.value("Managed").toBool()))
+        fields |= ManagedField;
+    if (assignValue(m_supportHotspot, m_deviceInfo.value("SupportHotspot").toBool()))
+        fields |= SupportHotspotField;
+    if (assignValue(m_interfaceFlags, uint(m_deviceInfo.value("InterfaceFlags").toInt())))
+        fields |= InterfaceFlagsField;
+
+    const int state = m_deviceInfo.value("State").toInt();
+    if (state != oldState)
+        fields |= StateField;
+
+    // 开头已经排除了数据完全相同的情况, 缓存的字段都没变时是 Driver 等没有单独缓存的字段变了
+    if (fields == NoField)
+        fields |= OtherField;
+
+    setDeviceStatus(state);
+
+    Q_EMIT deviceInfoChanged(fields);
 }
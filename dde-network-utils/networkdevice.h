@@ -26,10 +26,13 @@
 #ifndef NETWORKDEVICE_H
 #define NETWORKDEVICE_H
 
+#include "latencyhistogram.h"
+
 #include <QObject>
 #include <QJsonObject>
 #include <QSet>
 #include <QQueue>
+#include <QElapsedTimer>
 
 namespace dde {
 
@@ -66,6 +69,43 @@ public:
         Failed          = 120,
     };
 
+    // 连接过程中各阶段的耗时: Prepare->Config, Config->IpConfig(包含认证), IpConfig->Activated(DHCP),
+    // 以及从 Prepare 开始到失败的耗时
+    enum ConnectionPhase
+    {
+        PreparePhase,
+        ConfigPhase,
+        IpConfigPhase,
+        FailurePhase,
+        PhaseCount
+    };
+
+    struct StatusEntry
+    {
+        DeviceStatus status;
+        // 单调时钟, 以设备创建时为起点(毫秒)
+        qint64 timestamp;
+    };
+
+    // 状态历史保留的个数
+    enum { MaxStatusHistory = 4 };
+
+    // 设备信息中发生变化的字段
+    enum ChangedField
+    {
+        NoField             = 0x0,
+        StateField          = 0x1,
+        HwAddressField      = 0x2,
+        ClonedAddressField  = 0x4,
+        InterfaceField      = 0x8,
+        InterfaceFlagsField = 0x10,
+        SupportHotspotField = 0x20,
+        ManagedField        = 0x40,
+        OtherField          = 0x80,
+        PathField           = 0x100,
+    };
+    Q_DECLARE_FLAGS(ChangedFields, ChangedField)
+
 public:
     virtual ~NetworkDevice();
 
@@ -73,16 +113,25 @@ public:
     bool obtainIpFailed() const;
     DeviceType type() const { return m_type; }
     DeviceStatus status() const { return m_status; }
-    QQueue<DeviceStatus> statusQueue() const { return m_statusQueue; }
+    QQueue<DeviceStatus> statusQueue() const;
+    // 由旧到新的状态历史
+    QList<StatusEntry> statusHistory() const;
+    const LatencyHistogram phaseLatency(ConnectionPhase phase) const { return m_phaseLatency[phase]; }
     const QString statusString() const;
     const QString statusStringDetail() const;
     const QJsonObject info() const { return m_deviceInfo; }
-    const QString path() const;
-    const QString realHwAdr() const;
-    const QString usingHwAdr() const;
+    // 以下字段在 updateDeviceInfo 中解析一次, 读取时不再查找 json
+    const QString path() const { return m_path; }
+    const QString realHwAdr() const { return m_hwAddress; }
+    const QString usingHwAdr() const { return m_clonedAddress.isEmpty() ? m_hwAddress : m_clonedAddress; }
+    const QString clonedHwAdr() const { return m_clonedAddress; }
+    const QString interfaceName() const { return m_interface; }
+    bool managed() const { return m_managed; }
+    uint interfaceFlags() const { return m_interfaceFlags; }
 
 Q_SIGNALS:
     void removed() const;
+    void deviceInfoChanged(ChangedFields fields) const;
     void statusChanged(DeviceStatus stat) const;
     void statusChanged(const QString &statStr) const;
     void statusQueueChanged(const QQueue<DeviceStatus> &statusQueue) const;
@@ -96,19 +145,43 @@ private Q_SLOTS:
 protected:
     explicit NetworkDevice(const DeviceType type, const QJsonObject &info, QObject *parent = nullptr);
 
+    bool hotspotSupported() const { return m_supportHotspot; }
+
 private Q_SLOTS:
     void setDeviceStatus(const int status);
     void enqueueStatus(DeviceStatus status);
 
+private:
+    // index 为 0 时是最旧的状态
+    DeviceStatus statusAt(int index) const;
+    bool statusHistoryContains(DeviceStatus status) const;
+    void recordPhase(DeviceStatus status, qint64 timestamp);
+
 private:
     const DeviceType m_type;
     DeviceStatus m_status;
-    QQueue<DeviceStatus> m_statusQueue;
+    // 定长的环形缓冲区, m_statusHead 指向最旧的状态
+    StatusEntry m_statusRing[MaxStatusHistory];
+    int m_statusHead;
+    int m_statusCount;
+    QElapsedTimer m_statusClock;
+    // 每个阶段开始的时间, -1 表示不在该阶段中
+    qint64 m_phaseStarted[PhaseCount];
+    LatencyHistogram m_phaseLatency[PhaseCount];
     QJsonObject m_deviceInfo;
+    QString m_path;
+    QString m_hwAddress;
+    QString m_clonedAddress;
+    QString m_interface;
+    bool m_managed;
+    bool m_supportHotspot;
+    uint m_interfaceFlags;
 
     bool m_enabled;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(NetworkDevice::ChangedFields)
+
 }   // namespace network
 
 }   // namespace dde
@@ -27,16 +27,19 @@
 #include "networkdevice.h"
 #include "wirelessdevice.h"
 #include "wireddevice.h"
+#include "payloadparser.h"
+#include "networkcache.h"
 
 #include <QDebug>
+#include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QJsonDocument>
+
 #include <QJsonArray>
 #include <QJsonObject>
 
 using namespace dde::network;
 
-#define CONNECTED  2
-
 Connectivity NetworkModel::m_Connectivity(Connectivity::Full);
 
 NetworkDevice::DeviceType parseDeviceType(const QString &type)
@@ -51,18 +54,34 @@ NetworkDevice::DeviceType parseDeviceType(const QString &type)
     return NetworkDevice::None;
 }
 
-NetworkModel::NetworkModel(QObject *parent)
+NetworkModel::NetworkModel(QObject *parent, const bool cacheEnabled)
     : QObject(parent)
     , m_lastSecretDevice(nullptr)
     , m_connectivityChecker(new ConnectivityChecker)
     , m_connectivityCheckThread(new QThread(this))
+    , m_payloadHashes()
+    , m_processedUpdateCount(0)
+    , m_skippedUpdateCount(0)
+    , m_asyncParsing(false)
+    , m_payloadParser(new PayloadParser)
+    , m_payloadParseThread(nullptr)
+    , m_snapshot(std::make_shared<NetworkSnapshot>())
+    , m_generation(0)
+    , m_cache(nullptr)
+    , m_cacheLoadTime(-1)
 {
+
     connect(this, &NetworkModel::needCheckConnectivitySecondary,
             m_connectivityChecker, &ConnectivityChecker::startCheck);
     connect(m_connectivityChecker, &ConnectivityChecker::checkFinished,
             this, &NetworkModel::onConnectivitySecondaryCheckFinished);
 
     m_connectivityChecker->moveToThread(m_connectivityCheckThread);
+
+    if (cacheEnabled) {
+        m_cache = new NetworkCache(NetworkCache::defaultFileName(), this);
+        loadCache();
+    }
 }
 
 NetworkModel::~NetworkModel()
@@ -71,30 +90,70 @@ NetworkModel::~NetworkModel()
     qDebug() << "quit thread";
     m_connectivityCheckThread->quit();
     m_connectivityCheckThread->wait();
+
+    if (m_payloadParseThread) {
+        m_payloadParseThread->quit();
+        m_payloadParseThread->wait();
+    } else {
+        delete m_payloadParser;
+    }
 }
 
 const QString NetworkModel::connectionUuidByPath(const QString &connPath) const
 {
-    return connectionByPath(connPath).value("Uuid").toString();
+    const ConnectionRecord *record = findConnection(m_connectionsByPath, connPath);
+    return record ? record->uuid : QString();
 }
 
 const QString NetworkModel::connectionNameByPath(const QString &connPath) const
 {
-    return connectionByPath(connPath).value("Id").toString();
+    const ConnectionRecord *record = findConnection(m_connectionsByPath, connPath);
+    return record ? record->id : QString();
 }
 
 const QJsonObject NetworkModel::connectionByPath(const QString &connPath) const
 {
-    for (const auto &list : m_connections)
-    {
-        for (const auto &cfg : list)
-        {
-            if (cfg.value("Path").toString() == connPath)
-                return cfg;
-        }
-    }
+    return findConnectionObject(m_connectionsByPath, connPath);
+}
 
-    return QJsonObject();
+const QList<ConnectionRecord> NetworkModel::connectionRecords() const
+{
+    QList<ConnectionRecord> records;
+    records.reserve(m_connectionsByUuid.size());
+    for (auto it(m_connectionsByUuid.constBegin()); it != m_connectionsByUuid.constEnd(); ++it)
+        records << m_connections[it.value().first].at(it.value().second);
+
+    return records;
+}
+
+const ConnectionRecord NetworkModel::connectionRecordByUuid(const QString &uuid) const
+{
+    const ConnectionRecord *record = findConnection(m_connectionsByUuid, uuid);
+    return record ? *record : ConnectionRecord();
+}
+
+const ConnectionRecord NetworkModel::connectionRecordByPath(const QString &connPath) const
+{
+    const ConnectionRecord *record = findConnection(m_connectionsByPath, connPath);
+    return record ? *record : ConnectionRecord();
+}
+
+const ConnectionRecord *NetworkModel::findConnection(const QHash<QString, QPair<QString, int>> &index, const QString &key) const
+{
+    const auto it = index.constFind(key);
+    if (it == index.constEnd())
+        return nullptr;
+
+    return &m_connections.constFind(it.value().first).value().at(it.value().second);
+}
+
+const QJsonObject NetworkModel::findConnectionObject(const QHash<QString, QPair<QString, int>> &index, const QString &key) const
+{
+    const auto it = index.constFind(key);
+    if (it == index.constEnd())
+        return QJsonObject();
+
+    return m_connectionObjects.constFind(it.value().first).value().at(it.value().second);
 }
 
 const QJsonObject NetworkModel::activeConnObjectByUuid(const QString &uuid) const
@@ -110,16 +169,8 @@ const QJsonObject NetworkModel::activeConnObjectByUuid(const QString &uuid) cons
 
 const QString NetworkModel::connectionUuidByApInfo(const QJsonObject &apInfo) const
 {
-    for (const auto &list : m_connections)
-    {
-        for (const auto &cfg : list)
-        {
-            if (cfg.value("Ssid").toString() == apInfo.value("Ssid").toString())
-                return cfg.value("Uuid").toString();
-        }
-    }
-
-    return QString();
+    const ConnectionRecord *record = findConnection(m_connectionsBySsid, apInfo.value("Ssid").toString());
+    return record ? record->uuid : QString();
 }
 
 const QString NetworkModel::activeConnUuidByInfo(const QString &devPath, const QString &id) const
@@ -138,30 +189,17 @@ const QString NetworkModel::activeConnUuidByInfo(const QString &devPath, const Q
 
 const QJsonObject NetworkModel::connectionByUuid(const QString &uuid) const
 {
-    for (const auto &list : m_connections)
-    {
-        for (const auto &cfg : list)
-        {
-            if (cfg.value("Uuid").toString() == uuid)
-                return cfg;
-        }
-    }
-
-    return QJsonObject();
+    return findConnectionObject(m_connectionsByUuid, uuid);
 }
 
 void NetworkModel::onActivateAccessPointDone(const QString &devPath, const QString &apPath, const QString &uuid, const QDBusObjectPath path)
 {
-    for (auto const dev : m_devices)
-    {
-        if (dev->type() != NetworkDevice::Wireless || dev->path() != devPath)
-            continue;
+    NetworkDevice *dev = device(devPath);
+    if (dev == nullptr || dev->type() != NetworkDevice::Wireless)
+        return;
 
-        if (path.path().isEmpty()) {
-            Q_EMIT static_cast<WirelessDevice *>(dev)->activateAccessPointFailed(apPath, uuid);
-            return;
-        }
-    }
+    if (path.path().isEmpty())
+        Q_EMIT static_cast<WirelessDevice *>(dev)->activateAccessPointFailed(apPath, uuid);
 }
 
 void NetworkModel::onVPNEnabledChanged(const bool enabled)
@@ -220,59 +258,71 @@ void NetworkModel::onProxyIgnoreHostsChanged(const QString &hosts)
 
 void NetworkModel::onDevicesChanged(const QString &devices)
 {
-    const QJsonObject data = QJsonDocument::fromJson(devices.toUtf8()).object();
+    updateDevices(devices.toUtf8());
+}
 
+void NetworkModel::updateDevices(const QByteArray &devices)
+{
+    ingestPayload(NetworkSnapshot::DevicesPayload, devices);
+}
+
+void NetworkModel::applyDevices(const NetworkSnapshot &next)
+{
     QSet<QString> devSet;
+    QList<NetworkDevice *> partitionList;
 
     bool changed = false;
 
-    for (auto it(data.constBegin()); it != data.constEnd(); ++it) {
-        const auto type = parseDeviceType(it.key());
-        const auto list = it.value().toArray();
+    // 设备数据已经在解析时按 InterfaceFlags 过滤过了
+    for (const auto &entry : next.m_deviceEntries) {
+        const auto type = parseDeviceType(entry.first);
 
         if (type == NetworkDevice::None)
             continue;
 
-        for (auto const &l : list)
+        const QJsonObject &info = entry.second;
+        const QString path = info.value("Path").toString();
+
+        if (!devSet.contains(path)) {
+            devSet << path;
+        }
+
+        NetworkDevice *d = device(path);
+        // 路径在重启或热插拔后可能分配给了其它类型的设备(例如从缓存恢复的设备), 需要重新创建
+        if (d != nullptr && d->type() != type) {
+            m_devices.removeOne(d);
+            m_devicesByPath.remove(path);
+            d->deleteLater();
+            d = nullptr;
+        }
+
+        if (d == nullptr)
         {
-            const auto info = l.toObject();
-            const QString path = info.value("Path").toString();
-
-            // 根据标志位InterfaceFlags判断网络连接是否有效
-            if (type != NetworkDevice::Wireless) {
-                if (!info.value("InterfaceFlags").isUndefined()) {
-                    int flag = info.value("InterfaceFlags").toInt();
-                    if (!(flag & NM_DEVICE_INTERFACE_FLAG_UP)) {
-                        continue;
-                    }
-                }
-            }
+            changed = true;
 
-            if (!devSet.contains(path)) {
-                devSet << path;
+            switch (type)
+            {
+                case NetworkDevice::Wireless:
+                    d = new WirelessDevice(info, this);
+                    connect(static_cast<WirelessDevice *>(d), &WirelessDevice::wirelessScanRequested, this, &NetworkModel::requestWirelessScan);
+                    break;
+                case NetworkDevice::Wired:    d = new WiredDevice(info, this);    break;
+                default:;
             }
 
-            NetworkDevice *d = device(path);
-            if (d == nullptr)
-            {
-                changed = true;
-
-                switch (type)
-                {
-                    case NetworkDevice::Wireless: d = new WirelessDevice(info, this); break;
-                    case NetworkDevice::Wired:    d = new WiredDevice(info, this);    break;
-                    default:;
-                }
-
-                m_devices.append(d);
-
-                if (d != nullptr) {
-                    // init device enabled status
-                    Q_EMIT requestDeviceStatus(d->path());
-                }
-            } else {
-                d->updateDeviceInfo(info);
+            m_devices.append(d);
+
+            if (d != nullptr) {
+                m_devicesByPath.insert(d->path(), d);
+                partitionList << d;
+                // init device enabled status
+                Q_EMIT requestDeviceStatus(d->path());
             }
+        } else {
+            const QString hwAddr = d->realHwAdr();
+            d->updateDeviceInfo(info);
+            if (d->realHwAdr() != hwAddr)
+                partitionList << d;
         }
     }
 
@@ -286,6 +336,7 @@ void NetworkModel::onDevicesChanged(const QString &devices)
 
     for (auto const r : removeList) {
         m_devices.removeOne(r);
+        m_devicesByPath.remove(r->path());
         r->deleteLater();
     }
 
@@ -295,55 +346,66 @@ void NetworkModel::onDevicesChanged(const QString &devices)
 
 //    qDeleteAll(removeList);
 
+    // 新设备及 MAC 地址发生变化的设备需要重新分配连接
+    if (!partitionList.isEmpty()) {
+        partitionConnections(next, partitionList);
+    }
+
     if (changed) {
+        // 与设备相关的数据需要重新分配给新的设备列表, 即使后端重发的数据没有变化也不能跳过
+        invalidatePayload(NetworkSnapshot::ActiveConnectionsPayload);
+        invalidatePayload(NetworkSnapshot::ActiveConnInfoPayload);
+        invalidatePayload(NetworkSnapshot::AccessPointsPayload);
+
         Q_EMIT deviceListChanged(m_devices);
     }
 }
 
 void NetworkModel::onConnectionListChanged(const QString &conns)
 {
-    // m_connections 保存了所有从 NetworkManager 获取到的 connection
-    // m_connections 是一个以连接的类型为键(wired,wireless,vpn,pppoe,etc.), 以此类型的所有连接组成的 list 为值的 map
-
-    // commonConnections 的结构与 m_connection 一样, 但 commenConnection 只保存 "HwAddress" 属性为空的连接,
-    // 一个连接可以通过 "HwAddress" 属性 一对一的与设备关联起来, 因此:
-    // "HwAddress" 属性为空表示此连接所有设备都可以使用, 不为空则表示此连接只属于 "HwAddress" 指定的设备, 其他设备不应该拥有此连接
-
-    // deviceConnections 是一个以连接的 "HwAddress" 属性为键, 以一个 map 为值的 map
-    // 其子 map 的结构也与 m_connection 相同
-    // 这表示 deviceConnections 中的一个键值对代表了一个设备, 及其独有的各种类型的连接
+    updateConnectionList(conns.toUtf8());
+}
 
-    QMap< QString, QList< QJsonObject>> commonConnections;
-    QMap< QString, QMap< QString, QList< QJsonObject>>> deviceConnections;
+void NetworkModel::updateConnectionList(const QByteArray &conns)
+{
+    ingestPayload(NetworkSnapshot::ConnectionsPayload, conns);
+}
 
-    // 解析所有的 connection
-    const QJsonObject connsObject = QJsonDocument::fromJson(conns.toUtf8()).object();
-    for (auto it(connsObject.constBegin()); it != connsObject.constEnd(); ++it) {
-        const auto &connList = it.value().toArray();
-        const auto &connType = it.key();
-        if (connType.isEmpty())
-            continue;
+void NetworkModel::applyConnectionList(const NetworkSnapshot &next)
+{
+    // m_connections 保存了所有从 NetworkManager 获取到的 connection
+    // m_connections 是一个以连接的类型为键(wired,wireless,vpn,pppoe,etc.), 以此类型的所有连接组成的 list 为值的 map
+    // 连接记录, 索引及变化的连接都已经在生成快照时计算好, 这里只需替换
+    m_connections = next.m_connections;
+    m_connectionObjects = next.m_connectionObjects;
+    m_connectionsByUuid = next.m_connectionsByUuid;
+    m_connectionsByPath = next.m_connectionsByPath;
+    m_connectionsBySsid = next.m_connectionsBySsid;
+
+    if (next.m_addedConnections.isEmpty() && next.m_changedConnections.isEmpty() && next.m_removedConnections.isEmpty())
+        return;
 
-        m_connections[connType].clear();
+    // 将 connections 分配给具体的设备, 设备所属的连接没有变化时不会发出信号
+    partitionConnections(next, m_devices);
 
-        for (const auto &connObject : connList) {
-            const QJsonObject &connection = connObject.toObject();
+    for (const auto &conn : next.m_removedConnections)
+        Q_EMIT connectionRemoved(conn);
+    for (const auto &conn : next.m_addedConnections)
+        Q_EMIT connectionAdded(conn);
+    for (const auto &conn : next.m_changedConnections)
+        Q_EMIT connectionChanged(conn);
 
-            m_connections[connType].append(connection);
+    Q_EMIT connectionListChanged();
+}
 
-            const auto &hwAddr = connection.value("HwAddress").toString();
-            if (hwAddr.isEmpty()) {
-                commonConnections[connType].append(connection);
-            } else {
-                deviceConnections[hwAddr][connType].append(connection);
-            }
-        }
-    }
+void NetworkModel::partitionConnections(const NetworkSnapshot &source, const QList<NetworkDevice *> &devices)
+{
+    // 分组在生成快照时已经完成, 见 PayloadParser::buildConnections
+    const QMap<QString, QList<QJsonObject>> &commonConnections = source.m_commonConnections;
 
-    // 将 connections 分配给具体的设备
-    for (NetworkDevice *dev : m_devices) {
+    for (NetworkDevice *dev : devices) {
         const QString &hwAddr = dev->realHwAdr();
-        const QMap<QString, QList<QJsonObject>> &connsByType = deviceConnections.value(hwAddr);
+        const QMap<QString, QList<QJsonObject>> &connsByType = source.m_deviceConnections.value(hwAddr);
         QList<QJsonObject> destConns;
 
         switch (dev->type()) {
@@ -370,96 +432,80 @@ void NetworkModel::onConnectionListChanged(const QString &conns)
             break;
         }
     }
-
-    Q_EMIT connectionListChanged();
 }
 
 void NetworkModel::onActiveConnInfoChanged(const QString &conns)
 {
-    m_activeConnInfos.clear();
-
-    QMap<QString, QJsonObject> activeConnInfo;
-    QMap<QString, QJsonObject> activeHotspotInfo;
-
-    // parse active connections info and save it by DevicePath
-    QJsonArray activeConns = QJsonDocument::fromJson(conns.toUtf8()).array();
-    for (const auto &info : activeConns)
-    {
-        const auto &connInfo = info.toObject();
-        const auto &type = connInfo.value("ConnectionType").toString();
-        const auto &devPath = connInfo.value("Device").toString();
-
-        activeConnInfo.insertMulti(devPath, connInfo);
-        m_activeConnInfos << connInfo;
+    updateActiveConnInfo(conns.toUtf8());
+}
 
-        if (type == "wireless-hotspot") {
-            activeHotspotInfo.insert(devPath, connInfo);
-        }
-    }
+void NetworkModel::updateActiveConnInfo(const QByteArray &conns)
+{
+    ingestPayload(NetworkSnapshot::ActiveConnInfoPayload, conns);
+}
 
+void NetworkModel::applyActiveConnInfo(const NetworkSnapshot &next)
+{
     // update device active connection
+    // 只更新活动连接确实发生了变化的设备, 避免一个 VPN 重连导致所有设备都刷新
     for (auto *dev : m_devices)
     {
         const auto &devPath = dev->path();
+        const QList<QJsonObject> &devInfos = next.m_activeConnInfosByDevice.values(devPath);
 
         switch (dev->type())
         {
         case NetworkDevice::Wired:
         {
             WiredDevice *d = static_cast<WiredDevice *>(dev);
-            d->setActiveConnectionsInfo(activeConnInfo.values(devPath));
+            if (d->activeConnectionsInfo() != devInfos)
+                d->setActiveConnectionsInfo(devInfos);
             break;
         }
         case NetworkDevice::Wireless:
         {
             WirelessDevice *d = static_cast<WirelessDevice *>(dev);
-            d->setActiveConnectionsInfo(activeConnInfo.values(devPath));
-            d->setActiveHotspotInfo(activeHotspotInfo.value(devPath));
+            if (d->activeConnectionsInfo() != devInfos)
+                d->setActiveConnectionsInfo(devInfos);
+            d->setActiveHotspotInfo(next.m_activeHotspotInfos.value(devPath));
             break;
         }
         default:;
         }
     }
 
+    if (m_activeConnInfos == next.m_activeConnInfos)
+        return;
+
+    m_activeConnInfos = next.m_activeConnInfos;
+
     Q_EMIT activeConnInfoChanged(m_activeConnInfos);
 }
 
 void NetworkModel::onActiveConnectionsChanged(const QString &conns)
 {
-    m_activeConns.clear();
-
-    // 按照设备分类所有 active 连接
-    QMap<QString, QList<QJsonObject>> deviceActiveConnsMap;
+    updateActiveConnections(conns.toUtf8());
+}
 
-    const QJsonObject activeConns = QJsonDocument::fromJson(conns.toUtf8()).object();
-    for (auto it(activeConns.constBegin()); it != activeConns.constEnd(); ++it)
-    {
-        const QJsonObject &info = it.value().toObject();
-        if (info.isEmpty())
-            continue;
+void NetworkModel::updateActiveConnections(const QByteArray &conns)
+{
+    ingestPayload(NetworkSnapshot::ActiveConnectionsPayload, conns);
+}
 
-        m_activeConns << info;
-        int connectionState = info.value("State").toInt();
+void NetworkModel::applyActiveConnections(const NetworkSnapshot &next)
+{
+    m_activeConns = next.m_activeConns;
 
-        for (const auto &item : info.value("Devices").toArray()) {
-            const QString &devicePath = item.toString();
-            if (devicePath.isEmpty()) {
-                continue;
-            }
-            deviceActiveConnsMap[devicePath] << info;
-
-            NetworkDevice *dev = device(devicePath);
-            if (dev != nullptr) {
-                if (dev->status() != NetworkDevice::DeviceStatus::Activated && connectionState == CONNECTED) {
-                    qDebug() << devicePath << "The active connection status does not match the device connection status. It has been changed";
-                    dev->setDeviceStatus(NetworkDevice::DeviceStatus::Activated);
-                }
-            }
+    for (const QString &devicePath : next.m_activatedDevices) {
+        NetworkDevice *dev = device(devicePath);
+        if (dev != nullptr && dev->status() != NetworkDevice::DeviceStatus::Activated) {
+            qDebug() << devicePath << "The active connection status does not match the device connection status. It has been changed";
+            dev->setDeviceStatus(NetworkDevice::DeviceStatus::Activated);
         }
     }
 
     // 将 active 连接分配给具体的设备
-    for (auto it(deviceActiveConnsMap.constBegin()); it != deviceActiveConnsMap.constEnd(); ++it) {
+    for (auto it(next.m_activeConnsByDevice.constBegin()); it != next.m_activeConnsByDevice.constEnd(); ++it) {
         NetworkDevice *dev = device(it.key());
         if (dev == nullptr) {
             continue;
@@ -485,10 +531,8 @@ void NetworkModel::onActiveConnectionsChanged(const QString &conns)
 
 void NetworkModel::onConnectionSessionCreated(const QString &device, const QString &sessionPath)
 {
-    for (const auto dev : m_devices)
-    {
-        if (dev->path() != device)
-            continue;
+    NetworkDevice *dev = m_devicesByPath.value(device);
+    if (dev != nullptr) {
         Q_EMIT dev->sessionCreated(sessionPath);
         return;
     }
@@ -498,26 +542,20 @@ void NetworkModel::onConnectionSessionCreated(const QString &device, const QStri
 
 void NetworkModel::onDeviceAPListChanged(const QString &device, const QString &apList)
 {
-    for (auto const dev : m_devices)
-    {
-        if (dev->type() != NetworkDevice::Wireless || dev->path() != device)
-            continue;
-        return static_cast<WirelessDevice *>(dev)->setAPList(apList);
-    }
+    updateDeviceAPList(device, apList.toUtf8());
 }
 
-void NetworkModel::onDeviceEnableChanged(const QString &device, const bool enabled)
+void NetworkModel::updateDeviceAPList(const QString &devPath, const QByteArray &apList)
 {
-    NetworkDevice *dev = nullptr;
-    for (auto const d : m_devices)
-    {
-        if (d->path() == device)
-        {
-            dev = d;
-            break;
-        }
-    }
+    if (!containsDevice(devPath))
+        return;
+
+    ingestPayload(NetworkSnapshot::DeviceAccessPointsPayload, apList, devPath);
+}
 
+void NetworkModel::onDeviceEnableChanged(const QString &device, const bool enabled)
+{
+    NetworkDevice *dev = m_devicesByPath.value(device);
     if (!dev)
         return;
 
@@ -572,6 +610,175 @@ void NetworkModel::onConnectivitySecondaryCheckFinished(bool connectivity)
     Q_EMIT connectivityChanged(m_Connectivity);
 }
 
+// 64 位 FNV-1a, 只用来判断后端数据是否与上一次相同
+static quint64 payloadHash(const QByteArray &payload, quint64 hash = 14695981039346656037ULL)
+{
+    const char *data = payload.constData();
+    for (int i = 0; i < payload.size(); ++i) {
+        hash ^= static_cast<uchar>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+bool NetworkModel::payloadChanged(NetworkSnapshot::PayloadType type, const QByteArray &payload, const QString &devPath)
+{
+    // 单个设备的 AP 列表共用一个类型, 设备路径也要计入哈希
+    const quint64 hash = payloadHash(payload, payloadHash(devPath.toUtf8()));
+    if (m_payloadHashes[type] == hash) {
+        ++m_skippedUpdateCount;
+        return false;
+    }
+
+    m_payloadHashes[type] = hash;
+    ++m_processedUpdateCount;
+
+    return true;
+}
+
+void NetworkModel::invalidatePayload(NetworkSnapshot::PayloadType type)
+{
+    m_payloadHashes[type] = 0;
+}
+
+void NetworkModel::setAsyncParsing(const bool async)
+{
+    if (m_asyncParsing == async)
+        return;
+
+    m_asyncParsing = async;
+
+    if (async && m_payloadParseThread == nullptr) {
+        qRegisterMetaType<NetworkSnapshotPtr>();
+
+        m_payloadParseThread = new QThread(this);
+        m_payloadParser->moveToThread(m_payloadParseThread);
+
+        connect(m_payloadParseThread, &QThread::finished, m_payloadParser, &QObject::deleteLater);
+        connect(m_payloadParser, &PayloadParser::snapshotBuilt, this, &NetworkModel::onSnapshotBuilt, Qt::QueuedConnection);
+
+        m_payloadParseThread->start();
+    }
+
+    if (!async && m_payloadParseThread) {
+        // 之后会在界面线程中直接调用解析器, 先等待已经提交的数据处理完, 并应用其结果,
+        // 保证快照按数据到达的顺序生成
+        QMetaObject::invokeMethod(m_payloadParser, [] {}, Qt::BlockingQueuedConnection);
+        QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    }
+}
+
+void NetworkModel::ingestPayload(NetworkSnapshot::PayloadType type, const QByteArray &payload, const QString &devPath)
+{
+    if (!payloadChanged(type, payload, devPath))
+        return;
+
+    if (m_cache)
+        m_cache->store(type, payload);
+
+    if (m_asyncParsing) {
+        QMetaObject::invokeMethod(m_payloadParser, "parsePayload", Qt::QueuedConnection,
+                                  Q_ARG(int, type), Q_ARG(QByteArray, payload), Q_ARG(QString, devPath));
+        return;
+    }
+
+    onSnapshotBuilt(m_payloadParser->build(type, payload, devPath));
+}
+
+// 去掉设备数据中的 State 字段, 各类型设备列表的结构保持不变
+static QByteArray withoutDeviceState(const QByteArray &devices)
+{
+    QJsonObject types = QJsonDocument::fromJson(devices).object();
+    for (auto it = types.begin(); it != types.end(); ++it) {
+        QJsonArray list = it.value().toArray();
+        for (int i = 0; i < list.size(); ++i) {
+            QJsonObject dev = list.at(i).toObject();
+            dev.remove("State");
+            list[i] = dev;
+        }
+        it.value() = list;
+    }
+
+    return QJsonDocument(types).toJson(QJsonDocument::Compact);
+}
+
+void NetworkModel::loadCache()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!m_cache->load())
+        return;
+
+    // 与后端数据走同样的流程, 之后的实时数据通过正常的差异比较更新
+    const QByteArray &devices = m_cache->payload(NetworkSnapshot::DevicesPayload);
+    if (!devices.isEmpty()) {
+        // 缓存中的设备状态已经过时, 不使用, 设备保持 Unknown 状态直到收到实时数据.
+        // 去掉状态后的数据不计入差异比较, 也不写回缓存
+        onSnapshotBuilt(m_payloadParser->build(NetworkSnapshot::DevicesPayload, withoutDeviceState(devices), QString()));
+    }
+    const QByteArray &conns = m_cache->payload(NetworkSnapshot::ConnectionsPayload);
+    if (!conns.isEmpty())
+        updateConnectionList(conns);
+    const QByteArray &aps = m_cache->payload(NetworkSnapshot::AccessPointsPayload);
+    if (!aps.isEmpty()) {
+        updateWirelessAccessPoints(aps);
+
+        // 缓存中的 AP 可能已经不存在了, 收到第一份实时数据时直接移除, 不再等待过期,
+        // 因此实时数据与缓存相同时也不能跳过
+        for (auto const dev : m_devices) {
+            if (dev->type() == NetworkDevice::Wireless)
+                static_cast<WirelessDevice *>(dev)->markAPsCached();
+        }
+        invalidatePayload(NetworkSnapshot::AccessPointsPayload);
+    }
+
+    m_cacheLoadTime = timer.elapsed();
+}
+
+void NetworkModel::onSnapshotBuilt(const NetworkSnapshotPtr &next)
+{
+    // 界面线程只需替换快照中的数据, 分配给各个设备, 再根据变化发出信号
+    switch (next->m_changedPayload) {
+    case NetworkSnapshot::DevicesPayload:
+        applyDevices(*next);
+        break;
+    case NetworkSnapshot::ConnectionsPayload:
+        applyConnectionList(*next);
+        break;
+    case NetworkSnapshot::ActiveConnectionsPayload:
+        applyActiveConnections(*next);
+        break;
+    case NetworkSnapshot::ActiveConnInfoPayload:
+        applyActiveConnInfo(*next);
+        break;
+    case NetworkSnapshot::AccessPointsPayload:
+    case NetworkSnapshot::DeviceAccessPointsPayload:
+        applyWirelessAccessPoints(*next);
+        break;
+    default:
+        break;
+    }
+
+    publishSnapshot(next);
+}
+
+void NetworkModel::publishSnapshot(const NetworkSnapshotPtr &next)
+{
+    // 解析器还持有 next 作为下一次比较的基础, 复制一份再填充界面线程中的数据
+    std::shared_ptr<NetworkSnapshot> published = std::make_shared<NetworkSnapshot>(*next);
+
+    for (auto const dev : m_devices)
+        published->m_deviceInfos << dev->info();
+
+    published->m_generation = m_generation.load() + 1;
+
+    // 快照发布后即不再修改, 其它线程通过 snapshot() 原子地取得引用
+    std::atomic_store(&m_snapshot, NetworkSnapshotPtr(published));
+    m_generation.store(published->m_generation);
+}
+
 bool NetworkModel::containsDevice(const QString &devPath) const
 {
     return device(devPath) != nullptr;
@@ -579,11 +786,7 @@ bool NetworkModel::containsDevice(const QString &devPath) const
 
 NetworkDevice *NetworkModel::device(const QString &devPath) const
 {
-    for (auto const d : m_devices)
-        if (d->path() == devPath)
-            return d;
-
-    return nullptr;
+    return m_devicesByPath.value(devPath);
 }
 
 void NetworkModel::onAppProxyExistChanged(bool appProxyExist)
@@ -598,14 +801,22 @@ void NetworkModel::onAppProxyExistChanged(bool appProxyExist)
 }
 
 void NetworkModel::WirelessAccessPointsChanged(const QString &WirelessList)
+{
+    updateWirelessAccessPoints(WirelessList.toUtf8());
+}
+
+void NetworkModel::updateWirelessAccessPoints(const QByteArray &WirelessList)
 {
     //当数据非json的时候,则这个里面的项为0,则下面的for不会被执行
-    QJsonObject WirelessData = QJsonDocument::fromJson(WirelessList.toUtf8()).object();
-    for (QString Device : WirelessData.keys()) {
-        for (auto const dev : m_devices) {
-            //当类型不为无线网,path不为当前需要的device则进入下一个循环
-            if (dev->type() != NetworkDevice::Wireless || dev->path() != Device) continue;
-            return dynamic_cast<WirelessDevice *>(dev)->WirelessUpdate(WirelessData.value(Device));
-        }
+    ingestPayload(NetworkSnapshot::AccessPointsPayload, WirelessList);
+}
+
+void NetworkModel::applyWirelessAccessPoints(const NetworkSnapshot &next)
+{
+    for (const QString &devPath : next.m_changedApDevices) {
+        NetworkDevice *dev = device(devPath);
+        //当类型不为无线网,或者没有对应的设备则进入下一个循环
+        if (dev == nullptr || dev->type() != NetworkDevice::Wireless) continue;
+        static_cast<WirelessDevice *>(dev)->applyAPList(next.m_accessPoints.value(devPath));
     }
 }
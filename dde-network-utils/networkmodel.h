@@ -27,13 +27,20 @@
 #define NETWORKMODEL_H
 
 #include "networkdevice.h"
+#include "networkrecord.h"
+#include "networksnapshot.h"
 #include "connectivitychecker.h"
 
 #include <QMap>
+#include <QHash>
+#include <QVector>
+#include <QJsonArray>
 #include <QTimer>
 #include <QDBusObjectPath>
 #include <QThread>
 
+#include <atomic>
+
 namespace dde {
 
 namespace network {
@@ -66,6 +73,8 @@ enum InterfaceFlags
 
 class NetworkDevice;
 class NetworkWorker;
+class PayloadParser;
+class NetworkCache;
 class WirelessDevice;
 class NetworkModel : public QObject
 {
@@ -74,7 +83,8 @@ class NetworkModel : public QObject
     friend class NetworkWorker;
 
 public:
-    explicit NetworkModel(QObject *parent = nullptr);
+    // cacheEnabled 为 true 时在构造时读取并在之后维护磁盘缓存
+    explicit NetworkModel(QObject *parent = nullptr, const bool cacheEnabled = true);
     ~NetworkModel();
     ProxyConfig getChainsProxy() { return m_chainsProxy;}
 
@@ -83,16 +93,33 @@ public:
 
     static Connectivity connectivity() { return m_Connectivity; }
 
+    // 后端数据更新的统计: 实际处理的次数与因内容未变化而跳过的次数
+    quint64 processedUpdateCount() const { return m_processedUpdateCount; }
+    quint64 skippedUpdateCount() const { return m_skippedUpdateCount; }
+
+    // 开启后后端数据在单独的线程中解析并生成快照, 界面线程只负责替换快照, 分配给各个设备及发出信号,
+    // 此时各个 getter 的数据会比 DBus 信号稍晚更新
+    bool asyncParsing() const { return m_asyncParsing; }
+    void setAsyncParsing(const bool async);
+
+    // 以下两个接口可以在任意线程中调用, 其它接口只能在 model 所在的线程中使用
+    NetworkSnapshotPtr snapshot() const { return std::atomic_load(&m_snapshot); }
+    quint64 generation() const { return m_generation.load(); }
+
+    bool cacheEnabled() const { return m_cache; }
+    // 构造时从缓存恢复数据的耗时(毫秒), 没有读取到缓存时为 -1
+    qint64 cacheLoadTime() const { return m_cacheLoadTime; }
+
     const ProxyConfig proxy(const QString &type) const { return m_proxies[type]; }
     const QString autoProxy() const { return m_autoProxy; }
     const QString proxyMethod() const { return m_proxyMethod; }
     const QString ignoreHosts() const { return m_proxyIgnoreHosts; }
     const QList<NetworkDevice *> devices() const { return m_devices; }
-    const QList<QJsonObject> vpns() const { return m_connections.value("vpn"); }
-    const QList<QJsonObject> wireds() const { return m_connections.value("wired"); }
-    const QList<QJsonObject> wireless() const { return m_connections.value("wireless"); }
-    const QList<QJsonObject> pppoes() const { return m_connections.value("pppoe"); }
-    const QList<QJsonObject> hotspots() const { return m_connections.value("wireless-hotspot"); }
+    const QList<QJsonObject> vpns() const { return m_connectionObjects.value("vpn"); }
+    const QList<QJsonObject> wireds() const { return m_connectionObjects.value("wired"); }
+    const QList<QJsonObject> wireless() const { return m_connectionObjects.value("wireless"); }
+    const QList<QJsonObject> pppoes() const { return m_connectionObjects.value("pppoe"); }
+    const QList<QJsonObject> hotspots() const { return m_connectionObjects.value("wireless-hotspot"); }
     const QList<QJsonObject> activeConnInfos() const { return m_activeConnInfos; }
     const QList<QJsonObject> activeConns() const { return m_activeConns; }
     const QString connectionUuidByPath(const QString &connPath) const;
@@ -103,14 +130,23 @@ public:
     const QJsonObject connectionByPath(const QString &connPath) const;
     const QJsonObject activeConnObjectByUuid(const QString &uuid) const;
 
+    // 类型化的连接数据, 与上面返回 json 的接口内容一致
+    const QList<ConnectionRecord> connectionRecords() const;
+    const ConnectionRecord connectionRecordByUuid(const QString &uuid) const;
+    const ConnectionRecord connectionRecordByPath(const QString &connPath) const;
+
 Q_SIGNALS:
     void connectionListChanged() const;
+    void connectionAdded(const QJsonObject &connection) const;
+    void connectionRemoved(const QJsonObject &connection) const;
+    void connectionChanged(const QJsonObject &connection) const;
     void deviceEnableChanged(const QString &device, const bool enabled) const;
     void autoProxyChanged(const QString &proxy) const;
     void proxyChanged(const QString &type, const ProxyConfig &config) const;
     void proxyMethodChanged(const QString &proxyMethod) const;
     void proxyIgnoreHostsChanged(const QString &hosts) const;
     void requestDeviceStatus(const QString &devPath) const;
+    void requestWirelessScan() const;
     void activeConnectionsChanged(const QList<QJsonObject> &conns) const;
     void activeConnInfoChanged(const QList<QJsonObject> &infos) const;
     void vpnEnabledChanged(const bool enabled) const;
@@ -152,6 +188,7 @@ private Q_SLOTS:
     void onChainsUserChanged(const QString &user);
     void onChainsPasswdChanged(const QString &passwd);
     void onConnectivitySecondaryCheckFinished(bool connectivity);
+    void onSnapshotBuilt(const NetworkSnapshotPtr &next);
     /**
      * @def WirelessAccessPointsChanged
      * @brief 后端数据入口处,属性的修改会调用该函数
@@ -159,9 +196,32 @@ private Q_SLOTS:
      */
     void WirelessAccessPointsChanged(const QString &WirelessList);
 private:
+    bool payloadChanged(NetworkSnapshot::PayloadType type, const QByteArray &payload, const QString &devPath);
+    void invalidatePayload(NetworkSnapshot::PayloadType type);
+    void ingestPayload(NetworkSnapshot::PayloadType type, const QByteArray &payload, const QString &devPath = QString());
+    void publishSnapshot(const NetworkSnapshotPtr &next);
+    void loadCache();
+
+    // 以 UTF-8 字节流为输入的数据入口, 上面的 QString 槽函数只是对它们的转发
+    void updateDevices(const QByteArray &devices);
+    void updateConnectionList(const QByteArray &conns);
+    void updateActiveConnInfo(const QByteArray &conns);
+    void updateActiveConnections(const QByteArray &conns);
+    void updateDeviceAPList(const QString &devPath, const QByteArray &apList);
+    void updateWirelessAccessPoints(const QByteArray &WirelessList);
+
+    void applyDevices(const NetworkSnapshot &next);
+    void applyConnectionList(const NetworkSnapshot &next);
+    void applyActiveConnInfo(const NetworkSnapshot &next);
+    void applyActiveConnections(const NetworkSnapshot &next);
+    void applyWirelessAccessPoints(const NetworkSnapshot &next);
+
     bool containsDevice(const QString &devPath) const;
     NetworkDevice *device(const QString &devPath) const;
     void updateWiredConnInfo();
+    const ConnectionRecord *findConnection(const QHash<QString, QPair<QString, int>> &index, const QString &key) const;
+    const QJsonObject findConnectionObject(const QHash<QString, QPair<QString, int>> &index, const QString &key) const;
+    void partitionConnections(const NetworkSnapshot &source, const QList<NetworkDevice *> &devices);
 
 private:
     NetworkDevice *m_lastSecretDevice;
@@ -176,10 +236,32 @@ private:
     QString m_autoProxy;
     ProxyConfig m_chainsProxy;
     QList<NetworkDevice *> m_devices;
+    QHash<QString, NetworkDevice *> m_devicesByPath;
     QList<QJsonObject> m_activeConnInfos;
     QList<QJsonObject> m_activeConns;
     QMap<QString, ProxyConfig> m_proxies;
-    QMap<QString, QList<QJsonObject>> m_connections;
+    // 连接数据以类型为键, 类型化的记录用于查找, 原始 json 直接提供给使用者, 两者一一对应
+    QMap<QString, QVector<ConnectionRecord>> m_connections;
+    QMap<QString, QList<QJsonObject>> m_connectionObjects;
+    // 由 m_connections 派生的索引, 值为连接在 m_connections 中的 类型 及 下标, 与连接一起由快照替换
+    QHash<QString, QPair<QString, int>> m_connectionsByUuid;
+    QHash<QString, QPair<QString, int>> m_connectionsByPath;
+    QHash<QString, QPair<QString, int>> m_connectionsBySsid;
+
+    // 每种后端数据上一次内容的哈希值, 相同的数据不再重复解析
+    quint64 m_payloadHashes[NetworkSnapshot::PayloadTypeCount];
+    quint64 m_processedUpdateCount;
+    quint64 m_skippedUpdateCount;
+
+    bool m_asyncParsing;
+    // 同步模式下在界面线程中直接调用, 异步模式下移动到 m_payloadParseThread 中
+    PayloadParser *m_payloadParser;
+    QThread *m_payloadParseThread;
+    NetworkSnapshotPtr m_snapshot;
+    std::atomic<quint64> m_generation;
+
+    NetworkCache *m_cache;
+    qint64 m_cacheLoadTime;
 
     static Connectivity m_Connectivity;
 };
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "networkrecord.h"
+
+#include <QSet>
+#include <QMutex>
+#include <QMutexLocker>
+
+// 字符串池的上限, 超过后清空重新开始, 避免长时间运行时无限增长
+#define MaxInternPoolSize 4096
+
+namespace dde {
+
+namespace network {
+
+QString internString(const QString &str)
+{
+    static QMutex mutex;
+    static QSet<QString> pool;
+
+    if (str.isEmpty())
+        return QString();
+
+    QMutexLocker locker(&mutex);
+
+    const auto it = pool.constFind(str);
+    if (it != pool.constEnd())
+        return *it;
+
+    if (pool.size() >= MaxInternPoolSize)
+        pool.clear();
+
+    pool.insert(str);
+
+    return str;
+}
+
+ConnectionType ConnectionRecord::parseType(const QString &type)
+{
+    if (type == "wired")
+        return WiredConnection;
+    if (type == "wireless")
+        return WirelessConnection;
+    if (type == "wireless-hotspot")
+        return HotspotConnection;
+    if (type == "vpn" || type.startsWith("vpn-"))
+        return VpnConnection;
+    if (type == "pppoe")
+        return PppoeConnection;
+
+    return UnknownConnection;
+}
+
+ConnectionRecord ConnectionRecord::fromJson(const QJsonObject &connection, const QString &type)
+{
+    ConnectionRecord record;
+    record.uuid = connection.value("Uuid").toString();
+    record.id = connection.value("Id").toString();
+    record.path = connection.value("Path").toString();
+    record.ssid = internString(connection.value("Ssid").toString());
+    record.hwAddress = internString(connection.value("HwAddress").toString());
+    record.type = parseType(type);
+
+    return record;
+}
+
+AccessPointRecord AccessPointRecord::fromJson(const QJsonObject &ap)
+{
+    AccessPointRecord record;
+    record.path = ap.value("Path").toString();
+    record.ssid = internString(ap.value("Ssid").toString());
+    record.strength = ap.value("Strength").toInt();
+    record.secured = ap.value("Secured").toBool();
+    record.frequency = ap.value("Frequency").toInt();
+
+    return record;
+}
+
+}   // namespace network
+
+}   // namespace dde
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NETWORKRECORD_H
+#define NETWORKRECORD_H
+
+#include <QString>
+#include <QJsonObject>
+
+namespace dde {
+
+namespace network {
+
+enum ConnectionType
+{
+    UnknownConnection,
+    WiredConnection,
+    WirelessConnection,
+    HotspotConnection,
+    VpnConnection,
+    PppoeConnection,
+};
+
+/**
+ * @brief ConnectionRecord 是一个网络连接(NetworkManager 配置文件)解析后的类型化数据,
+ * 在解析后端数据时一次性填充, 避免每次读取字段都去查找 json
+ */
+struct ConnectionRecord
+{
+    QString uuid;
+    QString id;
+    QString path;
+    QString ssid;
+    QString hwAddress;
+    ConnectionType type = UnknownConnection;
+
+    bool isValid() const { return !uuid.isEmpty(); }
+
+    static ConnectionType parseType(const QString &type);
+    static ConnectionRecord fromJson(const QJsonObject &connection, const QString &type);
+};
+
+/**
+ * @brief AccessPointRecord 是一个无线接入点解析后的类型化数据
+ */
+struct AccessPointRecord
+{
+    QString path;
+    QString ssid;
+    int strength = 0;
+    bool secured = false;
+    int frequency = 0;
+
+    bool isValid() const { return !path.isEmpty(); }
+
+    static AccessPointRecord fromJson(const QJsonObject &ap);
+};
+
+/**
+ * @brief internString 返回与 str 相等的共享字符串, SSID 及 MAC 地址等大量重复出现的字符串
+ * 经过此函数后只保留一份数据
+ */
+QString internString(const QString &str);
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // NETWORKRECORD_H
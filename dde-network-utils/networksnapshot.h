@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NETWORKSNAPSHOT_H
+#define NETWORKSNAPSHOT_H
+
+#include "networkrecord.h"
+
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QList>
+#include <QVector>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QMetaType>
+
+#include <memory>
+
+namespace dde {
+
+namespace network {
+
+class NetworkSnapshot;
+typedef std::shared_ptr<const NetworkSnapshot> NetworkSnapshotPtr;
+
+/**
+ * @brief NetworkSnapshot 保存了某一时刻后端各项数据解析后的结果及 NetworkModel 的数据视图,
+ * 发布后不可修改, 因此可以在任意线程中读取. 快照由 PayloadParser 在解析数据时生成,
+ * 连接记录, 索引及按设备分配的结果都在生成时准备好, 界面线程只需替换并分配给各个设备.
+ * 未变化的数据在新旧快照之间隐式共享, generation 随每次发布单调递增
+ */
+class NetworkSnapshot
+{
+    friend class NetworkModel;
+    friend class PayloadParser;
+
+public:
+    enum PayloadType
+    {
+        DevicesPayload,
+        ConnectionsPayload,
+        ActiveConnectionsPayload,
+        ActiveConnInfoPayload,
+        AccessPointsPayload,
+        DeviceAccessPointsPayload,
+        PayloadTypeCount
+    };
+
+    NetworkSnapshot();
+
+    quint64 generation() const { return m_generation; }
+
+    // 与 NetworkModel 同名接口的数据一致
+    const QList<QJsonObject> deviceInfos() const { return m_deviceInfos; }
+    const QList<QJsonObject> vpns() const { return m_connectionObjects.value("vpn"); }
+    const QList<QJsonObject> wireds() const { return m_connectionObjects.value("wired"); }
+    const QList<QJsonObject> wireless() const { return m_connectionObjects.value("wireless"); }
+    const QList<QJsonObject> pppoes() const { return m_connectionObjects.value("pppoe"); }
+    const QList<QJsonObject> hotspots() const { return m_connectionObjects.value("wireless-hotspot"); }
+    const QList<QJsonObject> activeConnInfos() const { return m_activeConnInfos; }
+    const QList<QJsonObject> activeConns() const { return m_activeConns; }
+    // 无线设备的 AP 列表
+    const QJsonArray accessPoints(const QString &devPath) const { return m_accessPoints.value(devPath); }
+
+private:
+    quint64 m_generation;
+    // 界面线程中设备对象的信息, 在发布时填充
+    QList<QJsonObject> m_deviceInfos;
+
+    // 设备数据, 已按 InterfaceFlags 过滤, first 为设备类型
+    QList<QPair<QString, QJsonObject>> m_deviceEntries;
+
+    // 连接记录, 以及值为 类型 及 下标 的索引, 键重复时保留第一个
+    QMap<QString, QVector<ConnectionRecord>> m_connections;
+    // 与 m_connections 一一对应的原始 json, 没有变化的连接沿用上一份快照中的对象
+    QMap<QString, QList<QJsonObject>> m_connectionObjects;
+    QHash<QString, QPair<QString, int>> m_connectionsByUuid;
+    QHash<QString, QPair<QString, int>> m_connectionsByPath;
+    QHash<QString, QPair<QString, int>> m_connectionsBySsid;
+    // HwAddress 为空的连接所有设备共用, 以类型为键; 其它连接以 HwAddress 及类型为键
+    QMap<QString, QList<QJsonObject>> m_commonConnections;
+    QMap<QString, QMap<QString, QList<QJsonObject>>> m_deviceConnections;
+
+    QList<QJsonObject> m_activeConnInfos;
+    // 以设备路径为键, 一个设备可以有多个活动连接
+    QMultiMap<QString, QJsonObject> m_activeConnInfosByDevice;
+    QMap<QString, QJsonObject> m_activeHotspotInfos;
+
+    QList<QJsonObject> m_activeConns;
+    QMap<QString, QList<QJsonObject>> m_activeConnsByDevice;
+    // 存在已连接的活动连接的设备
+    QSet<QString> m_activatedDevices;
+
+    QMap<QString, QJsonArray> m_accessPoints;
+
+    // 相对上一份快照的变化, 只在界面线程应用该快照时使用
+    PayloadType m_changedPayload;
+    QList<QJsonObject> m_addedConnections;
+    QList<QJsonObject> m_changedConnections;
+    QList<QJsonObject> m_removedConnections;
+    QStringList m_changedApDevices;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+Q_DECLARE_METATYPE(dde::network::NetworkSnapshotPtr)
+
+#endif // NETWORKSNAPSHOT_H
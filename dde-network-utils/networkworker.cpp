@@ -24,30 +24,92 @@
  */
 
 #include "networkworker.h"
+#include "wirelessdevice.h"
+#include "wirelessscanscheduler.h"
 
 #include <QMetaProperty>
+#include <QFileInfo>
+
+#include <time.h>
+
+// 合并后端属性变化的默认时间窗口, 约为一帧
+#define DefaultUpdateInterval 16
+#define PropertiesInterface "org.freedesktop.DBus.Properties"
+// 获取初始属性失败时的重试间隔及次数
+#define DefaultInitRetryInterval 1000
+#define MaxInitRetries 3
+#define NetworkManagerService "org.freedesktop.NetworkManager"
+#define WirelessDeviceInterface "org.freedesktop.NetworkManager.Device.Wireless"
+#define ProxyChainsDir "/usr/bin"
+#define ProxyChainsPath "/usr/bin/proxychains4"
 
 using namespace dde::network;
 
+// NetworkManager 的 LastScan 属性使用的时钟(CLOCK_BOOTTIME), 单位为毫秒
+static qint64 bootTimeMSecs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+
+    return qint64(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
 NetworkWorker::NetworkWorker(NetworkModel *model, QObject *parent, bool sync)
     : QObject(parent),
       m_networkInter("com.deepin.daemon.Network", "/com/deepin/daemon/Network", QDBusConnection::sessionBus(), this),
       m_chainsInter(new ProxyChains("com.deepin.daemon.Network", "/com/deepin/daemon/Network/ProxyChains", QDBusConnection::sessionBus(), this)),
-      m_networkModel(model)
-{
+      m_networkModel(model),
+      m_updateTimer(new QTimer(this)),
+      m_coalescedUpdateCount(0),
+      m_scanScheduler(new WirelessScanScheduler(this)),
+      m_scanRequestedAt(-1),
+      m_initializeTime(-1),
+      m_initSerial(0),
+      m_initRetries(0),
+      m_initRetryInterval(DefaultInitRetryInterval),
+      m_initPropertiesApplied(false),
+      m_initActiveConnInfoReady(false),
+      m_binWatcher(new QFileSystemWatcher(this)),
+      m_appProxyExist(QFileInfo::exists(ProxyChainsPath))
+{
+    // 插拔扩展坞等场景下后端属性会在极短时间内连续变化多次,
+    // 这里先记录下最新的数据, 在时间窗口结束时按依赖顺序一次性交给 model 处理
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(DefaultUpdateInterval);
+    connect(m_updateTimer, &QTimer::timeout, this, &NetworkWorker::flushPendingUpdates);
+
     //对网络适配器的监听，当适配器消失及时响应
-    connect(&m_networkInter, &NetworkInter::ActiveConnectionsChanged, this, &NetworkWorker::queryActiveConnInfo, Qt::QueuedConnection);
-    connect(&m_networkInter, &NetworkInter::ActiveConnectionsChanged, m_networkModel, &NetworkModel::onActiveConnectionsChanged);
-    connect(&m_networkInter, &NetworkInter::DevicesChanged, m_networkModel, &NetworkModel::onDevicesChanged);
-    
-    connect(&m_networkInter, &NetworkInter::ConnectionsChanged, m_networkModel, &NetworkModel::onConnectionListChanged);
+    connect(&m_networkInter, &NetworkInter::ActiveConnectionsChanged, this, [=](const QString &conns) {
+        scheduleUpdate(ActiveConnectionsUpdate, conns);
+    });
+    connect(&m_networkInter, &NetworkInter::DevicesChanged, this, [=](const QString &devices) {
+        scheduleUpdate(DevicesUpdate, devices);
+    });
+    connect(&m_networkInter, &NetworkInter::ConnectionsChanged, this, [=](const QString &conns) {
+        scheduleUpdate(ConnectionsUpdate, conns);
+    });
+    connect(&m_networkInter, &NetworkInter::WirelessAccessPointsChanged, this, [=](const QString &aps) {
+        scheduleUpdate(AccessPointsUpdate, aps);
+    });
     connect(&m_networkInter, &NetworkInter::DeviceEnabled, m_networkModel, &NetworkModel::onDeviceEnableChanged);
-    connect(&m_networkInter, &NetworkInter::WirelessAccessPointsChanged, m_networkModel, &NetworkModel::WirelessAccessPointsChanged);
     connect(&m_networkInter, &NetworkInter::VpnEnabledChanged, m_networkModel, &NetworkModel::onVPNEnabledChanged);
     connect(m_networkModel, &NetworkModel::requestDeviceStatus, this, &NetworkWorker::queryDeviceStatus, Qt::QueuedConnection);
+    // 设备发起的扫描按退避的间隔执行, 界面直接调用 requestWirelessScan
+    connect(m_networkModel, &NetworkModel::requestWirelessScan, m_scanScheduler, &WirelessScanScheduler::requestBackgroundScan);
     connect(m_networkModel, &NetworkModel::deviceListChanged, this, [=]() {
         m_networkModel->onConnectionListChanged(m_networkInter.connections());
     }, Qt::QueuedConnection);
+    connect(m_networkModel, &NetworkModel::deviceListChanged, this, &NetworkWorker::watchWirelessDevices);
+
+    // 所有设备和界面的扫描请求都经过调度器合并
+    connect(m_scanScheduler, &WirelessScanScheduler::scanRequested, this, [=] {
+        m_scanRequestedAt = bootTimeMSecs();
+        m_networkInter.RequestWirelessScan();
+    });
+
+    // 安装或卸载 proxychains4 时更新应用代理是否可用
+    m_binWatcher->addPath(ProxyChainsDir);
+    connect(m_binWatcher, &QFileSystemWatcher::directoryChanged, this, &NetworkWorker::updateAppProxyExist);
 
     connect(m_chainsInter, &ProxyChains::IPChanged, model, &NetworkModel::onChainsAddrChanged);
     connect(m_chainsInter, &ProxyChains::PasswordChanged, model, &NetworkModel::onChainsPasswdChanged);
@@ -58,41 +120,250 @@ NetworkWorker::NetworkWorker(NetworkModel *model, QObject *parent, bool sync)
     m_networkInter.setSync(false);
     m_chainsInter->setSync(false);
 
+    // model 可能已经从缓存中恢复了设备, 这些设备创建时还没有人处理状态查询的请求
+    for (auto device : m_networkModel->devices())
+        queryDeviceStatus(device->path());
+    watchWirelessDevices(m_networkModel->devices());
     active(sync);
-    m_networkModel->WirelessAccessPointsChanged(m_networkInter.wirelessAccessPoints());
 }
 
 void NetworkWorker::active(bool bSync)
 {
     m_networkInter.blockSignals(false);
+    m_scanScheduler->setPeriodicScanEnabled(true);
+
+    // 所有属性通过一次 GetAll 获取, 与活动连接详情的查询同时发出,
+    // 返回后按 设备 -> 连接 -> 活动连接 -> AP 列表 -> 活动连接详情 的顺序更新 model
+    ++m_initSerial;
+    m_initClock.start();
+    m_initializeTime = -1;
+    m_initPropertiesApplied = false;
+    m_initActiveConnInfoReady = false;
+    m_initActiveConnInfo.clear();
+    m_initRetries = 0;
+
+    QDBusPendingCallWatcher *activeInfoWatcher = new QDBusPendingCallWatcher(m_networkInter.GetActiveConnectionInfo(), this);
+    activeInfoWatcher->setProperty("serial", m_initSerial);
+    connect(activeInfoWatcher, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::initActiveConnInfoCB);
 
-    //如果需要立即显示网络模块，则需要在active中使用同步方式获取网络设备数据
-    if (bSync) {
-        QVariant req = m_networkInter.property("Devices");
-        m_networkModel->onDevicesChanged(req.toString());
+    //如果需要立即显示网络模块，则需要在active中等待属性返回, 活动连接详情仍然异步获取
+    requestInitProperties(bSync);
+
+    m_networkModel->onAppProxyExistChanged(m_appProxyExist);
+}
+
+void NetworkWorker::requestInitProperties(bool sync)
+{
+    QDBusMessage getAll = QDBusMessage::createMethodCall(m_networkInter.service(), m_networkInter.path(), PropertiesInterface, "GetAll");
+    getAll << m_networkInter.interface();
+    QDBusPendingCallWatcher *propertiesWatcher = new QDBusPendingCallWatcher(m_networkInter.connection().asyncCall(getAll), this);
+    propertiesWatcher->setProperty("serial", m_initSerial);
+
+    if (sync) {
+        propertiesWatcher->waitForFinished();
+        applyInitProperties(*propertiesWatcher);
+        propertiesWatcher->deleteLater();
         qDebug() << Q_FUNC_INFO << "network active ,get devices size :" << m_networkModel->devices().size();
     } else {
-        m_networkModel->onDevicesChanged(m_networkInter.devices());
+        connect(propertiesWatcher, &QDBusPendingCallWatcher::finished, this, &NetworkWorker::initPropertiesCB);
     }
-    m_networkModel->onConnectionListChanged(m_networkInter.connections());
-    m_networkModel->onVPNEnabledChanged(m_networkInter.vpnEnabled());
-    m_networkModel->onActiveConnectionsChanged(m_networkInter.activeConnections());
+}
 
-    queryActiveConnInfo();
+void NetworkWorker::applyInitProperties(const QDBusPendingReply<QVariantMap> &reply)
+{
+    // 失败时返回的是空数据, 不能用它覆盖 model 中的设备和连接(可能是从缓存恢复的)
+    if (reply.isError()) {
+        qWarning() << Q_FUNC_INFO << "get network properties failed:" << reply.error().message();
 
-    for (auto device : m_networkModel->devices()) {
-        if (device->type() == NetworkDevice::Wireless) {
-            queryAccessPoints(device->path());
+        if (m_initRetries < MaxInitRetries) {
+            ++m_initRetries;
+            const int serial = m_initSerial;
+            QTimer::singleShot(m_initRetryInterval, this, [this, serial] {
+                if (serial == m_initSerial)
+                    requestInitProperties(false);
+            });
+            return;
         }
+
+        applyInitPropertyGetters();
+        return;
     }
 
-    const bool isAppProxyVaild = QProcess::execute("which", QStringList() << "/usr/bin/proxychains4") == 0;
-    m_networkModel->onAppProxyExistChanged(isAppProxyVaild);
+    const QVariantMap &props = reply.value();
+
+    // 请求发出后收到的属性变化信号比返回的数据旧, 不再处理
+    auto apply = [&](const QString &name, PendingUpdate update, void (NetworkModel::*updater)(const QString &)) {
+        if (!props.contains(name))
+            return;
+
+        m_pendingUpdates.remove(update);
+        (m_networkModel->*updater)(props.value(name).toString());
+    };
+
+    apply("Devices", DevicesUpdate, &NetworkModel::onDevicesChanged);
+    apply("Connections", ConnectionsUpdate, &NetworkModel::onConnectionListChanged);
+    if (props.contains("VpnEnabled"))
+        m_networkModel->onVPNEnabledChanged(props.value("VpnEnabled").toBool());
+    apply("ActiveConnections", ActiveConnectionsUpdate, &NetworkModel::onActiveConnectionsChanged);
+    apply("WirelessAccessPoints", AccessPointsUpdate, &NetworkModel::WirelessAccessPointsChanged);
+
+    m_initPropertiesApplied = true;
+    completeInitialization();
+}
+
+void NetworkWorker::applyInitPropertyGetters()
+{
+    // 多次重试都失败后退回到逐个读取属性, 异步模式下读取时还没有数据的属性,
+    // 其值返回后会通过对应的属性变化信号更新到 model
+    qWarning() << Q_FUNC_INFO << "fall back to reading network properties one by one";
+
+    const QString &devices = m_networkInter.devices();
+    if (!devices.isEmpty())
+        m_networkModel->onDevicesChanged(devices);
+    const QString &conns = m_networkInter.connections();
+    if (!conns.isEmpty())
+        m_networkModel->onConnectionListChanged(conns);
+    m_networkModel->onVPNEnabledChanged(m_networkInter.vpnEnabled());
+    const QString &activeConns = m_networkInter.activeConnections();
+    if (!activeConns.isEmpty())
+        m_networkModel->onActiveConnectionsChanged(activeConns);
+    const QString &aps = m_networkInter.wirelessAccessPoints();
+    if (!aps.isEmpty())
+        m_networkModel->WirelessAccessPointsChanged(aps);
+
+    m_initPropertiesApplied = true;
+    completeInitialization();
+}
+
+void NetworkWorker::completeInitialization()
+{
+    // 活动连接详情依赖设备及活动连接, 两者都准备好后才更新
+    if (!m_initPropertiesApplied || !m_initActiveConnInfoReady)
+        return;
+
+    m_networkModel->onActiveConnInfoChanged(m_initActiveConnInfo);
+    m_initActiveConnInfo.clear();
+
+    m_initializeTime = m_initClock.elapsed();
+    Q_EMIT initialized();
+}
+
+void NetworkWorker::updateAppProxyExist()
+{
+    m_appProxyExist = QFileInfo::exists(ProxyChainsPath);
+    m_networkModel->onAppProxyExistChanged(m_appProxyExist);
+}
+
+void NetworkWorker::watchWirelessDevices(const QList<NetworkDevice *> &devices)
+{
+    QStringList wirelessPaths;
+    for (NetworkDevice *device : devices) {
+        if (device->type() != NetworkDevice::Wireless)
+            continue;
+
+        WirelessDevice *wDevice = static_cast<WirelessDevice *>(device);
+        connect(wDevice, &WirelessDevice::apAdded, m_scanScheduler, &WirelessScanScheduler::onAccessPointSetChanged, Qt::UniqueConnection);
+        connect(wDevice, &WirelessDevice::apRemoved, m_scanScheduler, &WirelessScanScheduler::onAccessPointSetChanged, Qt::UniqueConnection);
+
+        // 扫描完成的时间及实际关联的 AP 只能从 NetworkManager 获取, 后端的 AP 数据在信号强度变化时也会更新
+        const QString &path = device->path();
+        wirelessPaths << path;
+        if (!m_scanWatchedDevices.contains(path))
+            QDBusConnection::systemBus().connect(NetworkManagerService, path, PropertiesInterface, "PropertiesChanged",
+                                                 this, SLOT(onWirelessPropertiesChanged(QString, QVariantMap, QStringList, QDBusMessage)));
+    }
+
+    for (const QString &path : m_scanWatchedDevices) {
+        if (!wirelessPaths.contains(path))
+            QDBusConnection::systemBus().disconnect(NetworkManagerService, path, PropertiesInterface, "PropertiesChanged",
+                                                    this, SLOT(onWirelessPropertiesChanged(QString, QVariantMap, QStringList, QDBusMessage)));
+    }
+
+    m_scanWatchedDevices = wirelessPaths;
+    m_scanScheduler->onWirelessDevicesChanged(wirelessPaths);
+}
+
+void NetworkWorker::onWirelessPropertiesChanged(const QString &interface, const QVariantMap &changed, const QStringList &invalidated, const QDBusMessage &message)
+{
+    Q_UNUSED(invalidated)
+
+    if (interface != WirelessDeviceInterface)
+        return;
+
+    // 以设备实际关联的 AP 判断漫游, 同名网络中信号最强的 AP 随信号波动变化, 不代表漫游
+    if (changed.contains("ActiveAccessPoint")) {
+        const QString &apPath = qdbus_cast<QDBusObjectPath>(changed.value("ActiveAccessPoint")).path();
+        m_scanScheduler->onActiveAccessPointChanged(message.path(), apPath == "/" ? QString() : apPath);
+    }
+
+    if (!changed.contains("LastScan"))
+        return;
+
+    // LastScan 为扫描完成的时间, 早于请求时间的是 NetworkManager 自行发起的扫描, 不计入统计
+    if (m_scanRequestedAt >= 0 && changed.value("LastScan").toLongLong() >= m_scanRequestedAt) {
+        m_scanRequestedAt = -1;
+        m_scanScheduler->onScanFinished();
+    }
+}
+
+void NetworkWorker::setUpdateInterval(int msec)
+{
+    m_updateTimer->setInterval(qMax(0, msec));
+}
+
+int NetworkWorker::updateInterval() const
+{
+    return m_updateTimer->interval();
+}
+
+void NetworkWorker::setInitRetryInterval(int msec)
+{
+    m_initRetryInterval = qMax(0, msec);
+}
+
+void NetworkWorker::scheduleUpdate(PendingUpdate update, const QString &payload)
+{
+    // 窗口内同一属性只保留最新的一份数据
+    if (m_pendingUpdates.contains(update))
+        ++m_coalescedUpdateCount;
+
+    m_pendingUpdates.insert(update, payload);
+
+    if (!m_updateTimer->isActive())
+        m_updateTimer->start();
+}
+
+void NetworkWorker::flushPendingUpdates()
+{
+    // QMap 按键值有序, 即按 设备 -> 连接 -> 活动连接 -> AP 列表 的依赖顺序处理
+    const QMap<int, QString> updates = m_pendingUpdates;
+    m_pendingUpdates.clear();
+
+    for (auto it(updates.constBegin()); it != updates.constEnd(); ++it) {
+        switch (it.key()) {
+        case DevicesUpdate:
+            m_networkModel->onDevicesChanged(it.value());
+            break;
+        case ConnectionsUpdate:
+            m_networkModel->onConnectionListChanged(it.value());
+            break;
+        case ActiveConnectionsUpdate:
+            m_networkModel->onActiveConnectionsChanged(it.value());
+            queryActiveConnInfo();
+            break;
+        case AccessPointsUpdate:
+            m_networkModel->WirelessAccessPointsChanged(it.value());
+            break;
+        default:
+            break;
+        }
+    }
 }
 
 void NetworkWorker::deactive()
 {
     m_networkInter.blockSignals(true);
+    m_scanScheduler->setPeriodicScanEnabled(false);
 }
 
 void NetworkWorker::setVpnEnable(const bool enable)
@@ -173,7 +444,7 @@ void NetworkWorker::queryProxy(const QString &type)
 
 void NetworkWorker::requestWirelessScan()
 {
-    m_networkInter.RequestWirelessScan();
+    m_scanScheduler->requestScan();
 }
 
 void NetworkWorker::queryChains()
@@ -395,3 +666,25 @@ void NetworkWorker::queryActiveConnInfoCB(QDBusPendingCallWatcher *w)
 
     w->deleteLater();
 }
+
+void NetworkWorker::initPropertiesCB(QDBusPendingCallWatcher *w)
+{
+    // 期间再次调用了 active(), 以最新的一次为准
+    if (w->property("serial").toInt() == m_initSerial)
+        applyInitProperties(*w);
+
+    w->deleteLater();
+}
+
+void NetworkWorker::initActiveConnInfoCB(QDBusPendingCallWatcher *w)
+{
+    if (w->property("serial").toInt() == m_initSerial) {
+        QDBusPendingReply<QString> reply = *w;
+
+        m_initActiveConnInfo = reply.value();
+        m_initActiveConnInfoReady = true;
+        completeInitialization();
+    }
+
+    w->deleteLater();
+}
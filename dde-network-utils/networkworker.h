@@ -29,6 +29,10 @@
 #include "networkmodel.h"
 
 #include <QObject>
+#include <QMap>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
 
 #include <com_deepin_daemon_network.h>
 #include <com_deepin_daemon_network_proxychains.h>
@@ -40,6 +44,8 @@ namespace network {
 using NetworkInter = com::deepin::daemon::Network;
 using ProxyChains = com::deepin::daemon::network::ProxyChains;
 
+class WirelessScanScheduler;
+
 class NetworkWorker : public QObject
 {
     Q_OBJECT
@@ -50,6 +56,24 @@ public:
     void active(bool bSync = false);
     void deactive();
 
+    // 后端属性变化的合并窗口, 单位为毫秒, 0 表示在下一次事件循环时处理
+    void setUpdateInterval(int msec);
+    int updateInterval() const;
+    // 获取初始属性失败时的重试间隔, 单位为毫秒, 重试 3 次后改为逐个读取属性
+    void setInitRetryInterval(int msec);
+    int initRetryInterval() const { return m_initRetryInterval; }
+    // 因被同一窗口内更新的数据覆盖而未单独处理的属性变化次数
+    quint64 coalescedUpdateCount() const { return m_coalescedUpdateCount; }
+    // 无线扫描调度器, 可用于调整扫描间隔及查看扫描统计
+    WirelessScanScheduler *scanScheduler() const { return m_scanScheduler; }
+    // 最近一次 active() 的初始数据是否已经全部更新到 model 中
+    bool isInitialized() const { return m_initializeTime >= 0; }
+    // 最近一次 active() 到 model 数据完整所用的时间, 单位为毫秒, 未完成时为 -1
+    qint64 initializeTime() const { return m_initializeTime; }
+
+Q_SIGNALS:
+    void initialized() const;
+
 public Q_SLOTS:
     void activateConnection(const QString &devPath, const QString &uuid);
     void activateAccessPoint(const QString &devPath, const QString &apPath, const QString &uuid);
@@ -92,11 +116,56 @@ private Q_SLOTS:
     void queryConnectionSessionCB(QDBusPendingCallWatcher *w);
     void queryDeviceStatusCB(QDBusPendingCallWatcher *w);
     void queryActiveConnInfoCB(QDBusPendingCallWatcher *w);
+    void initPropertiesCB(QDBusPendingCallWatcher *w);
+    void initActiveConnInfoCB(QDBusPendingCallWatcher *w);
+    void flushPendingUpdates();
+    void updateAppProxyExist();
+    void onWirelessPropertiesChanged(const QString &interface, const QVariantMap &changed, const QStringList &invalidated, const QDBusMessage &message);
+
+private:
+    // 数值即处理顺序
+    enum PendingUpdate
+    {
+        DevicesUpdate,
+        ConnectionsUpdate,
+        ActiveConnectionsUpdate,
+        AccessPointsUpdate,
+    };
+
+    void scheduleUpdate(PendingUpdate update, const QString &payload);
+    void watchWirelessDevices(const QList<NetworkDevice *> &devices);
+    void requestInitProperties(bool sync);
+    void applyInitProperties(const QDBusPendingReply<QVariantMap> &reply);
+    void applyInitPropertyGetters();
+    void completeInitialization();
 
 private:
     NetworkInter m_networkInter;
     ProxyChains *m_chainsInter;
     NetworkModel *m_networkModel;
+
+    QTimer *m_updateTimer;
+    QMap<int, QString> m_pendingUpdates;
+    quint64 m_coalescedUpdateCount;
+
+    WirelessScanScheduler *m_scanScheduler;
+    // 最近一次发起扫描的时间(CLOCK_BOOTTIME), 收到该次扫描完成后置为 -1
+    qint64 m_scanRequestedAt;
+    QStringList m_scanWatchedDevices;
+
+    // 启动时的初始数据, 由 active() 并行请求, 按依赖顺序更新到 model
+    QElapsedTimer m_initClock;
+    qint64 m_initializeTime;
+    int m_initSerial;
+    int m_initRetries;
+    int m_initRetryInterval;
+    bool m_initPropertiesApplied;
+    bool m_initActiveConnInfoReady;
+    QString m_initActiveConnInfo;
+
+    // proxychains4 是否已安装, 由 /usr/bin 的变化更新, active() 时不再检查文件系统
+    QFileSystemWatcher *m_binWatcher;
+    bool m_appProxyExist;
 };
 
 }   // namespace network
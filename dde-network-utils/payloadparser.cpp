@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "payloadparser.h"
+#include "networkmodel.h"
+
+#include <QDebug>
+#include <QJsonParseError>
+
+using namespace dde::network;
+
+#define CONNECTED  2
+
+// 内容相同时沿用上一份数据中同一位置的对象, 界面线程比较时只需比较内部指针
+static void shareUnchanged(QList<QJsonObject> &list, const QList<QJsonObject> &previous)
+{
+    const int count = qMin(list.size(), previous.size());
+    for (int i = 0; i < count; ++i) {
+        if (list.at(i) == previous.at(i))
+            list[i] = previous.at(i);
+    }
+}
+
+PayloadParser::PayloadParser(QObject *parent)
+    : QObject(parent)
+    , m_state(std::make_shared<NetworkSnapshot>())
+{
+
+}
+
+// 后端数据均为 UTF-8 编码的 json, 直接由字节流解析, 每份数据只解析一次
+QJsonDocument PayloadParser::parse(const QByteArray &payload, const char *name)
+{
+    if (payload.isEmpty())
+        return QJsonDocument();
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(payload, &error);
+    if (error.error != QJsonParseError::NoError)
+        qWarning() << "parse" << name << "failed:" << error.errorString();
+
+    return doc;
+}
+
+NetworkSnapshotPtr PayloadParser::build(int type, const QByteArray &payload, const QString &devPath)
+{
+    // 只是复制了一些隐式共享的容器, 代价很小
+    std::shared_ptr<NetworkSnapshot> next = std::make_shared<NetworkSnapshot>(*m_state);
+    next->m_changedPayload = NetworkSnapshot::PayloadType(type);
+    next->m_addedConnections.clear();
+    next->m_changedConnections.clear();
+    next->m_removedConnections.clear();
+    next->m_changedApDevices.clear();
+
+    const QJsonDocument &doc = parse(payload, "payload");
+
+    switch (type) {
+    case NetworkSnapshot::DevicesPayload:
+        buildDevices(*next, doc.object());
+        break;
+    case NetworkSnapshot::ConnectionsPayload:
+        buildConnections(*next, doc.object());
+        break;
+    case NetworkSnapshot::ActiveConnectionsPayload:
+        buildActiveConnections(*next, doc.object());
+        break;
+    case NetworkSnapshot::ActiveConnInfoPayload:
+        buildActiveConnInfo(*next, doc.array());
+        break;
+    case NetworkSnapshot::AccessPointsPayload:
+        buildAccessPoints(*next, doc.object());
+        break;
+    case NetworkSnapshot::DeviceAccessPointsPayload:
+        next->m_accessPoints.insert(devPath, doc.array());
+        next->m_changedApDevices << devPath;
+        break;
+    default:
+        break;
+    }
+
+    m_state = next;
+
+    return next;
+}
+
+void PayloadParser::parsePayload(int type, const QByteArray &payload, const QString &devPath)
+{
+    Q_EMIT snapshotBuilt(build(type, payload, devPath));
+}
+
+void PayloadParser::buildDevices(NetworkSnapshot &next, const QJsonObject &data) const
+{
+    QHash<QString, QJsonObject> previous;
+    for (const auto &entry : m_state->m_deviceEntries)
+        previous.insert(entry.second.value("Path").toString(), entry.second);
+
+    next.m_deviceEntries.clear();
+
+    for (auto it(data.constBegin()); it != data.constEnd(); ++it) {
+        const QString &type = it.key();
+
+        for (const auto &l : it.value().toArray()) {
+            QJsonObject info = l.toObject();
+
+            // 根据标志位InterfaceFlags判断网络连接是否有效
+            if (type != "wireless" && !info.value("InterfaceFlags").isUndefined()) {
+                const int flag = info.value("InterfaceFlags").toInt();
+                if (!(flag & NM_DEVICE_INTERFACE_FLAG_UP))
+                    continue;
+            }
+
+            // 没有变化的设备沿用原来的对象, 设备的 updateDeviceInfo 可以立即返回
+            const auto old = previous.constFind(info.value("Path").toString());
+            if (old != previous.constEnd() && old.value() == info)
+                info = old.value();
+
+            next.m_deviceEntries.append(qMakePair(type, info));
+        }
+    }
+}
+
+void PayloadParser::buildConnections(NetworkSnapshot &next, const QJsonObject &connsObject) const
+{
+    const NetworkSnapshot &prev = *m_state;
+    auto objectAt = [](const NetworkSnapshot &snapshot, const QPair<QString, int> &location) -> const QJsonObject & {
+        return snapshot.m_connectionObjects.constFind(location.first).value().at(location.second);
+    };
+
+    // 只替换数据中存在的连接类型
+    for (auto it(connsObject.constBegin()); it != connsObject.constEnd(); ++it) {
+        const auto &connList = it.value().toArray();
+        const auto &connType = it.key();
+        if (connType.isEmpty())
+            continue;
+
+        QVector<ConnectionRecord> &typeConnections = next.m_connections[connType];
+        QList<QJsonObject> &typeObjects = next.m_connectionObjects[connType];
+        typeConnections.clear();
+        typeObjects.clear();
+        typeConnections.reserve(connList.size());
+        typeObjects.reserve(connList.size());
+
+        for (const auto &connObject : connList) {
+            QJsonObject connection = connObject.toObject();
+            const ConnectionRecord &record = ConnectionRecord::fromJson(connection, connType);
+
+            // 没有变化的连接沿用原来的对象, 使用者及设备比较连接时只需比较指针
+            const auto old = prev.m_connectionsByUuid.constFind(record.uuid);
+            if (old != prev.m_connectionsByUuid.constEnd()) {
+                const QJsonObject &oldConnection = objectAt(prev, old.value());
+                if (oldConnection == connection)
+                    connection = oldConnection;
+            }
+
+            typeConnections.append(record);
+            typeObjects.append(connection);
+        }
+    }
+
+    next.m_connectionsByUuid.clear();
+    next.m_connectionsByPath.clear();
+    next.m_connectionsBySsid.clear();
+
+    // 与原先的线性查找保持一致: 遍历顺序相同, 键重复时保留第一个
+    for (auto it(next.m_connections.constBegin()); it != next.m_connections.constEnd(); ++it) {
+        const QVector<ConnectionRecord> &records = it.value();
+        for (int row = 0; row < records.size(); ++row) {
+            const ConnectionRecord &record = records.at(row);
+            const QPair<QString, int> location(it.key(), row);
+
+            if (!record.uuid.isEmpty() && !next.m_connectionsByUuid.contains(record.uuid))
+                next.m_connectionsByUuid.insert(record.uuid, location);
+
+            if (!record.path.isEmpty() && !next.m_connectionsByPath.contains(record.path))
+                next.m_connectionsByPath.insert(record.path, location);
+
+            if (!record.ssid.isEmpty() && !next.m_connectionsBySsid.contains(record.ssid))
+                next.m_connectionsBySsid.insert(record.ssid, location);
+        }
+    }
+
+    // 后端的连接列表经常整体重发, 但其中往往只有个别连接发生了变化,
+    // 因此这里以 UUID 为键对比新旧两份数据, 只对真正变化了的连接发出信号
+    for (auto it(next.m_connectionsByUuid.constBegin()); it != next.m_connectionsByUuid.constEnd(); ++it) {
+        const QJsonObject &connection = objectAt(next, it.value());
+        const auto old = prev.m_connectionsByUuid.constFind(it.key());
+        if (old == prev.m_connectionsByUuid.constEnd())
+            next.m_addedConnections << connection;
+        else if (objectAt(prev, old.value()) != connection)
+            next.m_changedConnections << connection;
+    }
+
+    for (auto it(prev.m_connectionsByUuid.constBegin()); it != prev.m_connectionsByUuid.constEnd(); ++it) {
+        if (!next.m_connectionsByUuid.contains(it.key()))
+            next.m_removedConnections << objectAt(prev, it.value());
+    }
+
+    // m_commonConnections 只保存 "HwAddress" 属性为空的连接, 一个连接可以通过 "HwAddress" 属性 一对一的与设备关联起来, 因此:
+    // "HwAddress" 属性为空表示此连接所有设备都可以使用, 不为空则表示此连接只属于 "HwAddress" 指定的设备, 其他设备不应该拥有此连接
+    // m_deviceConnections 中的一个键值对代表了一个设备, 及其独有的各种类型的连接
+    next.m_commonConnections.clear();
+    next.m_deviceConnections.clear();
+
+    // 只有这几种类型的连接需要分配给设备
+    for (const QString &connType : { QStringLiteral("wired"), QStringLiteral("wireless"), QStringLiteral("wireless-hotspot") }) {
+        const QVector<ConnectionRecord> &records = next.m_connections.value(connType);
+        const QList<QJsonObject> &connections = next.m_connectionObjects.value(connType);
+        for (int row = 0; row < records.size(); ++row) {
+            const ConnectionRecord &record = records.at(row);
+            if (record.hwAddress.isEmpty())
+                next.m_commonConnections[connType].append(connections.at(row));
+            else
+                next.m_deviceConnections[record.hwAddress][connType].append(connections.at(row));
+        }
+    }
+}
+
+void PayloadParser::buildActiveConnInfo(NetworkSnapshot &next, const QJsonArray &activeConns) const
+{
+    next.m_activeConnInfos.clear();
+    next.m_activeConnInfosByDevice.clear();
+    next.m_activeHotspotInfos.clear();
+
+    for (const auto &info : activeConns)
+        next.m_activeConnInfos << info.toObject();
+
+    shareUnchanged(next.m_activeConnInfos, m_state->m_activeConnInfos);
+
+    // parse active connections info and save it by DevicePath
+    for (const auto &connInfo : next.m_activeConnInfos) {
+        const auto &type = connInfo.value("ConnectionType").toString();
+        const auto &devPath = connInfo.value("Device").toString();
+
+        next.m_activeConnInfosByDevice.insert(devPath, connInfo);
+
+        if (type == "wireless-hotspot")
+            next.m_activeHotspotInfos.insert(devPath, connInfo);
+    }
+}
+
+void PayloadParser::buildActiveConnections(NetworkSnapshot &next, const QJsonObject &activeConns) const
+{
+    next.m_activeConns.clear();
+    next.m_activeConnsByDevice.clear();
+    next.m_activatedDevices.clear();
+
+    for (auto it(activeConns.constBegin()); it != activeConns.constEnd(); ++it) {
+        const QJsonObject &info = it.value().toObject();
+        if (!info.isEmpty())
+            next.m_activeConns << info;
+    }
+
+    shareUnchanged(next.m_activeConns, m_state->m_activeConns);
+
+    // 按照设备分类所有 active 连接
+    for (const auto &info : next.m_activeConns) {
+        const bool connected = info.value("State").toInt() == CONNECTED;
+
+        for (const auto &item : info.value("Devices").toArray()) {
+            const QString &devicePath = item.toString();
+            if (devicePath.isEmpty())
+                continue;
+
+            next.m_activeConnsByDevice[devicePath] << info;
+            if (connected)
+                next.m_activatedDevices << devicePath;
+        }
+    }
+}
+
+void PayloadParser::buildAccessPoints(NetworkSnapshot &next, const QJsonObject &wirelessData) const
+{
+    next.m_accessPoints.clear();
+
+    for (auto it(wirelessData.constBegin()); it != wirelessData.constEnd(); ++it) {
+        next.m_accessPoints.insert(it.key(), it.value().toArray());
+        next.m_changedApDevices << it.key();
+    }
+}
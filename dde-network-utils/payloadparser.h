@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAYLOADPARSER_H
+#define PAYLOADPARSER_H
+
+#include "networksnapshot.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QJsonDocument>
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief PayloadParser 负责解析后端的 json 数据, 并在上一份快照的基础上生成新的 NetworkSnapshot,
+ * 连接记录, 索引, 变化的连接及按设备分配的结果都在这里计算.
+ * 可以移动到单独的线程中运行, 以免大量数据的处理阻塞界面线程
+ */
+class PayloadParser : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PayloadParser(QObject *parent = nullptr);
+
+    static QJsonDocument parse(const QByteArray &payload, const char *name);
+
+    // 只能在解析器所在的线程中调用, 或者在该线程空闲时直接调用
+    NetworkSnapshotPtr build(int type, const QByteArray &payload, const QString &devPath);
+
+Q_SIGNALS:
+    void snapshotBuilt(const NetworkSnapshotPtr &snapshot) const;
+
+public Q_SLOTS:
+    void parsePayload(int type, const QByteArray &payload, const QString &devPath);
+
+private:
+    void buildDevices(NetworkSnapshot &next, const QJsonObject &data) const;
+    void buildConnections(NetworkSnapshot &next, const QJsonObject &connsObject) const;
+    void buildActiveConnInfo(NetworkSnapshot &next, const QJsonArray &activeConns) const;
+    void buildActiveConnections(NetworkSnapshot &next, const QJsonObject &activeConns) const;
+    void buildAccessPoints(NetworkSnapshot &next, const QJsonObject &wirelessData) const;
+
+private:
+    // 最近一次生成的快照, 作为下一次比较的基础
+    NetworkSnapshotPtr m_state;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // PAYLOADPARSER_H
@@ -1,13 +1,27 @@
-SOURCES += $$PWD/connectivitychecker.cpp \
+SOURCES += $$PWD/accesspointranking.cpp \
+           $$PWD/connectivitychecker.cpp \
+           $$PWD/latencyhistogram.cpp \
+           $$PWD/networkcache.cpp \
            $$PWD/networkdevice.cpp \
            $$PWD/networkmodel.cpp \
+           $$PWD/networkrecord.cpp \
+           $$PWD/networksnapshot.cpp \
            $$PWD/networkworker.cpp \
+           $$PWD/payloadparser.cpp \
            $$PWD/wireddevice.cpp \
-           $$PWD/wirelessdevice.cpp
+           $$PWD/wirelessdevice.cpp \
+           $$PWD/wirelessscanscheduler.cpp
 
-HEADERS += $$PWD/connectivitychecker.h \
+HEADERS += $$PWD/accesspointranking.h \
+           $$PWD/connectivitychecker.h \
+           $$PWD/latencyhistogram.h \
+           $$PWD/networkcache.h \
            $$PWD/networkdevice.h \
            $$PWD/networkmodel.h \
+           $$PWD/networkrecord.h \
+           $$PWD/networksnapshot.h \
            $$PWD/networkworker.h \
+           $$PWD/payloadparser.h \
            $$PWD/wireddevice.h \
-           $$PWD/wirelessdevice.h
+           $$PWD/wirelessdevice.h \
+           $$PWD/wirelessscanscheduler.h
@@ -42,6 +42,9 @@ const QList<QJsonObject> WiredDevice::connections() const
 
 void WiredDevice::setConnections(const QList<QJsonObject> &connections)
 {
+    if (m_connections == connections)
+        return;
+
     m_connections = connections;
 
     Q_EMIT connectionsChanged(m_connections);
@@ -66,9 +69,17 @@ void WiredDevice::setActiveConnections(const QList<QJsonObject> &activeConns)
 
 void WiredDevice::setActiveConnectionsInfo(const QList<QJsonObject> &activeConnInfoList)
 {
+    if (m_activeConnectionsInfo == activeConnInfoList)
+        return;
+
+    const QJsonObject oldWiredInfo = activeWiredConnectionInfo();
+
     m_activeConnectionsInfo = activeConnInfoList;
 
-    Q_EMIT activeWiredConnectionInfoChanged(activeWiredConnectionInfo());
+    const QJsonObject &wiredInfo = activeWiredConnectionInfo();
+    if (wiredInfo != oldWiredInfo)
+        Q_EMIT activeWiredConnectionInfoChanged(wiredInfo);
+
     Q_EMIT activeConnectionsInfoChanged(m_activeConnectionsInfo);
 }
 
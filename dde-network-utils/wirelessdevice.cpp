@@ -37,15 +37,155 @@ using namespace dde::network;
 #define WIRELESS_PATH  "Path"
 #define WIRELESS_STRENGTH  "Strength"
 
+// 默认不做平滑及滞回: 内容相同的数据不会重复下发, 平滑后的值无法在没有新数据时收敛到实际值
+#define DefaultStrengthSmoothing 1.0
+#define DefaultStrengthHysteresis 0
+// 扫描结果中消失的 AP 在这段时间内没有再次出现才会被移除
+#define DefaultApExpiry (20 * 1000)
+
+static WirelessDevice::AccessPointFields diffAccessPoint(const QJsonObject &oldAp, const QJsonObject &newAp)
+{
+    WirelessDevice::AccessPointFields fields;
+
+    if (oldAp.value(WIRELESS_STRENGTH) != newAp.value(WIRELESS_STRENGTH))
+        fields |= WirelessDevice::StrengthField;
+    if (oldAp.value("Secured") != newAp.value("Secured") || oldAp.value("SecuredInEap") != newAp.value("SecuredInEap"))
+        fields |= WirelessDevice::SecurityField;
+    if (oldAp.value("Frequency") != newAp.value("Frequency"))
+        fields |= WirelessDevice::FrequencyField;
+    if (oldAp.value("Ssid") != newAp.value("Ssid"))
+        fields |= WirelessDevice::SsidField;
+
+    // 调用者只对不相等的两份数据调用此函数, 这里没有逐一比较的字段(如 Path)发生变化时记为 OtherField,
+    // 保证 apFieldsChanged 的接收者至少能看到一个标志位
+    if (fields == WirelessDevice::NoField)
+        fields |= WirelessDevice::OtherField;
+
+    return fields;
+}
+
 WirelessDevice::WirelessDevice(const QJsonObject &info, QObject *parent)
     : NetworkDevice(NetworkDevice::Wireless, info, parent)
-    , m_networkInter("com.deepin.daemon.Network", "/com/deepin/daemon/Network", QDBusConnection::sessionBus(), this)
+    , m_apListDirty(false)
+    , m_batchUpdating(false)
+    , m_strengthSmoothing(DefaultStrengthSmoothing)
+    , m_strengthHysteresis(DefaultStrengthHysteresis)
+    , m_apUpdateInterval(0)
+    , m_suppressedApUpdateCount(0)
+    , m_apExpiry(DefaultApExpiry)
+    , m_apListSerial(0)
+    , m_expiryTimer(new QTimer(this))
+    , m_throttleTimer(new QTimer(this))
+{
+    m_apClock.start();
+
+    m_expiryTimer->setInterval(qMax(1000, m_apExpiry / 4));
+    connect(m_expiryTimer, &QTimer::timeout, this, &WirelessDevice::sweepExpiredAPs);
+
+    m_throttleTimer->setSingleShot(true);
+    connect(m_throttleTimer, &QTimer::timeout, this, &WirelessDevice::flushThrottledAPs);
+}
+
+void WirelessDevice::setApExpiry(int msec)
+{
+    m_apExpiry = qMax(0, msec);
+    m_expiryTimer->setInterval(qMax(1000, m_apExpiry / 4));
+
+    if (m_expiryTimer->isActive() || m_apExpiry == 0)
+        sweepExpiredAPs();
+}
+
+qint64 WirelessDevice::apLastSeen(const QString &apPath) const
+{
+    const auto it = m_strengthStates.constFind(apPath);
+    return it == m_strengthStates.constEnd() ? -1 : it->lastSeen;
+}
+
+void WirelessDevice::sweepExpiredAPs()
+{
+    const qint64 now = m_apClock.elapsed();
+    // 还有未过期但在最近一次扫描中缺失的 AP 时继续计时
+    bool pending = false;
+
+    m_batchUpdating = true;
+    for (const QString &path : m_apsMap.keys()) {
+        const StrengthState &state = m_strengthStates.value(path);
+        if (state.listSerial == m_apListSerial)
+            continue;
+
+        if (now - state.lastSeen >= m_apExpiry)
+            removeAP(path);
+        else
+            pending = true;
+    }
+    m_batchUpdating = false;
+
+    if (!pending)
+        m_expiryTimer->stop();
+
+    updateActiveAp();
+}
+
+void WirelessDevice::setStrengthSmoothing(double alpha)
+{
+    m_strengthSmoothing = qBound(0.01, alpha, 1.0);
+}
+
+void WirelessDevice::setStrengthHysteresis(int hysteresis)
+{
+    m_strengthHysteresis = qMax(0, hysteresis);
+}
+
+void WirelessDevice::setApUpdateInterval(int msec)
+{
+    m_apUpdateInterval = qMax(0, msec);
+
+    // 按新的间隔重新安排被推迟的通知
+    if (!m_throttledAps.isEmpty())
+        flushThrottledAPs();
+}
+
+void WirelessDevice::flushThrottledAPs()
+{
+    const qint64 now = m_apClock.elapsed();
+    qint64 next = -1;
+
+    QList<QJsonObject> ready;
+    for (auto it(m_throttledAps.begin()); it != m_throttledAps.end();) {
+        const qint64 wait = m_strengthStates.value(it.key()).updated + m_apUpdateInterval - now;
+        if (m_apUpdateInterval == 0 || wait <= 0) {
+            ready << it.value();
+            it = m_throttledAps.erase(it);
+        } else {
+            next = next < 0 ? wait : qMin(next, wait);
+            ++it;
+        }
+    }
+
+    if (!ready.isEmpty()) {
+        m_batchUpdating = true;
+        for (const QJsonObject &ap : ready)
+            applyAP(ap);
+        m_batchUpdating = false;
+
+        updateActiveAp();
+    }
+
+    if (next >= 0)
+        m_throttleTimer->start(int(next));
+    else
+        m_throttleTimer->stop();
+}
+
+int WirelessDevice::rawApStrength(const QString &apPath) const
 {
+    const auto it = m_strengthStates.constFind(apPath);
+    return it == m_strengthStates.constEnd() ? 0 : it->raw;
 }
 
 bool WirelessDevice::supportHotspot() const
 {
-    return info()["SupportHotspot"].toBool();
+    return hotspotSupported();
 }
 
 const QString WirelessDevice::activeHotspotUuid() const
@@ -108,94 +248,322 @@ const QString WirelessDevice::activeWirelessConnSettingPath() const
     return conn.isEmpty() ? QString() : conn.value("SettingPath").toString();
 }
 
+const QJsonArray WirelessDevice::rankedApList() const
+{
+    QJsonArray aps;
+    for (const QString &path : m_ranking.paths())
+        aps.append(m_apsMap.value(path));
+
+    return aps;
+}
+
 const QJsonArray WirelessDevice::apList() const
 {
-    QJsonArray apArray;
-    for (auto ap : m_ssidDatas.values()) {
-        apArray.append(QJsonDocument::fromJson(ap.toUtf8()).object());
+    // AP 列表只在发生变化后的第一次访问时重新生成
+    if (m_apListDirty) {
+        m_apList = QJsonArray();
+        for (const auto &ap : m_apsMap)
+            m_apList.append(ap);
+        m_apListDirty = false;
     }
-    return apArray;
+
+    return m_apList;
 }
 
 void WirelessDevice::updateWirlessAp()
 {
-    m_networkInter.RequestWirelessScan();
+    Q_EMIT wirelessScanRequested();
 }
 
 void WirelessDevice::setAPList(const QString &apList)
 {
-    QMap<QString, QJsonObject> apsMapOld = m_apsMap;
-    m_apsMap.clear();
+    applyAPList(QJsonDocument::fromJson(apList.toUtf8()).array());
+}
 
-    const QJsonArray &apArray = QJsonDocument::fromJson(apList.toUtf8()).array();
-    for (auto item : apArray) {
-        const QJsonObject &ap = item.toObject();
-        const QString &path = ap.value(WIRELESS_PATH).toString();
+void WirelessDevice::applyAPList(const QJsonArray &apArray)
+{
+    //本次数据中出现的全部 AP 的路径
+    QSet<QString> paths;
+    ++m_apListSerial;
+    //批量更新过程中不切换当前连接的 AP, 全部处理完后再统一选择
+    m_batchUpdating = true;
+    for (const QJsonValue &data : apArray) {
+        //数据为空则进行下一个循环
+        if (data.isNull()) continue;
+        //数据转换
+        const QJsonObject &apInfo = data.toObject();
+        //当不存在两个Key的时候,则进行下一个循环
+        if (!apInfo.contains(WIRELESS_PATH) && !apInfo.contains(WIRELESS_STRENGTH)) continue;
 
-        if (!path.isEmpty()) {
-            if (ap.value("Ssid").toString() == activeApSsid() &&
-                    ap.value(WIRELESS_STRENGTH).toInt() > activeApStrength()) {
-                m_activeApInfo = ap;
-                Q_EMIT activeApInfoChanged(m_activeApInfo);
-            }
+        //没有路径的 AP 不会被 insertAP 加入, 也不能计入 paths, 否则下面按数量判断是否需要删除会出错
+        const QString &path = apInfo.value(WIRELESS_PATH).toString();
+        if (path.isEmpty()) continue;
 
-            if (!apsMapOld.contains(path)) {
-                Q_EMIT apAdded(ap);
-            } else {
-                if (apsMapOld.value(path) != ap) {
-                    m_activeApInfo = ap;
-                    Q_EMIT apInfoChanged(ap);
-                }
-            }
-            m_apsMap.insert(path, ap);
-        }
+        paths << path;
+        //没有的会加上, 有的只在内容变化时才会更新
+        insertAP(apInfo);
     }
 
-    for (auto path : apsMapOld.keys()) {
-        if (!m_apsMap.contains(path)) {
-            Q_EMIT apRemoved(apsMapOld.value(path));
+    //本次数据中的 AP 都已在 m_apsMap 中, 数量相同说明没有需要删除的 AP
+    if (m_apsMap.size() > paths.size()) {
+        //从缓存恢复的 AP 没有在实时数据中出现, 说明已经不存在了, 不需要等待过期
+        for (const QString &path : m_apsMap.keys()) {
+            if (!paths.contains(path) && (m_apExpiry == 0 || m_strengthStates.value(path).cached)) {
+                removeAP(path);
+            }
         }
+
+        //信号较弱的 AP 经常在某次扫描中缺失, 等到过期后再移除, 避免列表反复增删
+        if (m_apsMap.size() > paths.size() && !m_expiryTimer->isActive())
+            m_expiryTimer->start();
     }
 
+    m_batchUpdating = false;
+
+    //获取相同id中信号最大值
     setActiveApBySsid(activeApSsidByActiveConnUuid(activeWirelessConnUuid()));
 }
 
+void WirelessDevice::markAPsCached()
+{
+    for (auto it(m_strengthStates.begin()); it != m_strengthStates.end(); ++it)
+        it.value().cached = true;
+}
+
 void WirelessDevice::updateAPInfo(const QString &apInfo)
 {
-    const auto &ap = QJsonDocument::fromJson(apInfo.toUtf8()).object();
+    insertAP(QJsonDocument::fromJson(apInfo.toUtf8()).object());
+}
+
+void WirelessDevice::deleteAP(const QString &apInfo)
+{
+    removeAP(QJsonDocument::fromJson(apInfo.toUtf8()).object().value(WIRELESS_PATH).toString());
+}
+
+void WirelessDevice::insertAP(const QJsonObject &rawAp)
+{
+    const auto &path = rawAp.value(WIRELESS_PATH).toString();
+    if (path.isEmpty())
+        return;
+
+    // 对外的信号强度经过平滑和滞回处理, 原始值只保存在 m_strengthStates 中
+    const int raw = rawAp.value(WIRELESS_STRENGTH).toInt();
+    const qint64 now = m_apClock.elapsed();
+    StrengthState &state = m_strengthStates[path];
+    state.lastSeen = now;
+    state.listSerial = m_apListSerial;
+    state.cached = false;
+    const bool rawChanged = state.raw != raw;
+    int strength = raw;
+    if (state.updated == 0) {
+        state.average = raw;
+        state.strength = raw;
+    } else {
+        state.average += m_strengthSmoothing * (raw - state.average);
+        strength = qRound(state.average);
+        if (qAbs(strength - state.strength) < m_strengthHysteresis)
+            strength = state.strength;
+    }
+    state.raw = raw;
+
+    QJsonObject ap = rawAp;
+    if (strength != raw)
+        ap.insert(WIRELESS_STRENGTH, strength);
+
+    const auto it = m_apsMap.constFind(path);
+    if (it != m_apsMap.constEnd() && it.value() == ap) {
+        // 推迟的变化已经恢复, 不需要再通知
+        m_throttledAps.remove(path);
+        if (rawChanged)
+            ++m_suppressedApUpdateCount;
+        return;
+    }
+
+    // 限制同一个 AP 只有信号强度变化时的通知频率, 窗口内只保留最新的数据, 在窗口结束时通知
+    if (it != m_apsMap.constEnd() && m_apUpdateInterval > 0 && now - state.updated < m_apUpdateInterval &&
+            diffAccessPoint(it.value(), ap) == StrengthField) {
+        ++m_suppressedApUpdateCount;
+        m_throttledAps.insert(path, ap);
+
+        const qint64 wait = state.updated + m_apUpdateInterval - now;
+        if (!m_throttleTimer->isActive() || wait < m_throttleTimer->remainingTime())
+            m_throttleTimer->start(int(qMax<qint64>(0, wait)));
+        return;
+    }
+
+    m_throttledAps.remove(path);
+    applyAP(ap);
+}
+
+void WirelessDevice::applyAP(const QJsonObject &ap)
+{
     const auto &path = ap.value(WIRELESS_PATH).toString();
+    StrengthState &state = m_strengthStates[path];
+    state.strength = ap.value(WIRELESS_STRENGTH).toInt();
+    // 加 1 以区分从未更新过的状态
+    state.updated = m_apClock.elapsed() + 1;
+
+    const auto it = m_apsMap.find(path);
+
+    const AccessPointRecord record = AccessPointRecord::fromJson(ap);
+    QString oldSsid;
+    if (it != m_apsMap.end()) {
+        const AccessPointRecord &oldRecord = m_apRecords.value(path);
+        oldSsid = oldRecord.ssid;
+        unindexAP(oldRecord);
+    }
+    m_apRecords.insert(path, record);
+    indexAP(record);
+    m_apListDirty = true;
+
+    if (it != m_apsMap.end()) {
+        const AccessPointFields fields = diffAccessPoint(it.value(), ap);
+        it.value() = ap;
+        Q_EMIT apInfoChanged(ap);
+        Q_EMIT apFieldsChanged(ap, fields);
+    } else {
+        m_apsMap.insert(path, ap);
+        Q_EMIT apAdded(ap);
+    }
 
-    if (!path.isEmpty()) {
-        if (ap.value("Ssid").toString() == activeApSsid() &&
-                ap.value(WIRELESS_STRENGTH).toInt() > activeApStrength()) {
-            m_activeApInfo = ap;
-            Q_EMIT activeApInfoChanged(m_activeApInfo);
-        }
+    if (oldSsid != record.ssid)
+        updateNetwork(oldSsid);
+    updateNetwork(record.ssid);
+    rankAP(ap, record);
 
-        if (m_apsMap.contains(path)) {
-            m_activeApInfo = ap;
-            Q_EMIT apInfoChanged(ap);
-        } else {
-            Q_EMIT apAdded(ap);
+    if (!m_batchUpdating)
+        updateActiveAp();
+}
+
+void WirelessDevice::removeAP(const QString &path)
+{
+    if (path.isEmpty() || !m_apsMap.contains(path))
+        return;
+
+    const QJsonObject ap = m_apsMap.take(path);
+    const AccessPointRecord record = m_apRecords.take(path);
+    m_strengthStates.remove(path);
+    m_throttledAps.remove(path);
+    unindexAP(record);
+    m_apListDirty = true;
+
+    Q_EMIT apRemoved(ap);
+
+    updateNetwork(record.ssid);
+
+    const int row = m_ranking.remove(path);
+    if (row >= 0)
+        Q_EMIT apRankRemoved(ap, row);
+
+    if (!m_batchUpdating)
+        updateActiveAp();
+}
+
+void WirelessDevice::indexAP(const AccessPointRecord &record)
+{
+    // 隐藏网络没有 SSID, 不会成为当前连接的 AP
+    if (record.ssid.isEmpty())
+        return;
+
+    m_ssidPaths[record.ssid].insert(record.path);
+
+    const auto strongest = m_strongestPaths.constFind(record.ssid);
+    if (strongest == m_strongestPaths.constEnd() ||
+            record.strength > m_apRecords.value(strongest.value()).strength) {
+        m_strongestPaths.insert(record.ssid, record.path);
+    }
+}
+
+void WirelessDevice::unindexAP(const AccessPointRecord &record)
+{
+    const auto it = m_ssidPaths.find(record.ssid);
+    if (it == m_ssidPaths.end())
+        return;
+
+    it.value().remove(record.path);
+    if (it.value().isEmpty()) {
+        m_ssidPaths.erase(it);
+        m_strongestPaths.remove(record.ssid);
+        return;
+    }
+
+    // 只有移除的是信号最强的 AP 时才需要在同名的 AP 中重新选择
+    if (m_strongestPaths.value(record.ssid) != record.path)
+        return;
+
+    QString strongestPath;
+    int strongest = -1;
+    for (const QString &path : it.value()) {
+        const int strength = m_apRecords.value(path).strength;
+        if (strength > strongest) {
+            strongest = strength;
+            strongestPath = path;
         }
-        // QMap will replace existing key-value
-        m_apsMap.insert(path, ap);
     }
+    m_strongestPaths.insert(record.ssid, strongestPath);
 }
 
-void WirelessDevice::deleteAP(const QString &apInfo)
+void WirelessDevice::rankAP(const QJsonObject &ap, const AccessPointRecord &record)
 {
-    const auto &ap = QJsonDocument::fromJson(apInfo.toUtf8()).object();
-    const auto &path = ap.value(WIRELESS_PATH).toString();
+    const int from = m_ranking.indexOf(record.path);
+    const int to = m_ranking.insert(record.path, record.ssid, record.strength, m_knownSsids.contains(record.ssid));
 
-    if (!path.isEmpty()) {
-        if (m_apsMap.contains(path)) {
-            m_apsMap.remove(path);
-            Q_EMIT apRemoved(ap);
+    if (from < 0)
+        Q_EMIT apRankInserted(ap, to);
+    else if (from != to)
+        Q_EMIT apMoved(ap, from, to);
+}
+
+void WirelessDevice::updateNetwork(const QString &ssid)
+{
+    if (ssid.isEmpty())
+        return;
+
+    const auto paths = m_ssidPaths.constFind(ssid);
+    if (paths == m_ssidPaths.constEnd()) {
+        const auto it = m_networks.find(ssid);
+        if (it != m_networks.end()) {
+            const QJsonObject network = it.value();
+            m_networks.erase(it);
+            Q_EMIT networkRemoved(network);
         }
+        return;
+    }
+
+    // 网络的信息取自同名 AP 中信号最强的一个
+    const AccessPointRecord &strongest = m_apRecords.value(m_strongestPaths.value(ssid));
+    QJsonObject network;
+    network.insert("Ssid", ssid);
+    network.insert("Path", strongest.path);
+    network.insert("Strength", strongest.strength);
+    network.insert("Secured", strongest.secured);
+    network.insert("BssidCount", paths.value().size());
+
+    auto it = m_networks.find(ssid);
+    if (it == m_networks.end()) {
+        m_networks.insert(ssid, network);
+        Q_EMIT networkAdded(network);
+    } else if (it.value() != network) {
+        it.value() = network;
+        Q_EMIT networkChanged(network);
     }
 }
 
+void WirelessDevice::updateActiveAp()
+{
+    const QString &path = m_strongestPaths.value(m_activeSsid);
+    const QJsonObject &ap = path.isEmpty() ? QJsonObject() : m_apsMap.value(path);
+    if (ap == m_activeApInfo)
+        return;
+
+    const bool switched = path != activeApPath();
+    m_activeApInfo = ap;
+
+    // 同一个 AP 的信号强度等信息变化已经通过 apInfoChanged 通知过了
+    if (switched)
+        Q_EMIT activeApInfoChanged(m_activeApInfo);
+}
+
 void WirelessDevice::setActiveConnections(const QList<QJsonObject> &activeConns)
 {
     m_activeConnections = activeConns;
@@ -205,21 +573,27 @@ void WirelessDevice::setActiveConnections(const QList<QJsonObject> &activeConns)
 
 void WirelessDevice::setActiveConnectionsInfo(const QList<QJsonObject> &activeConnsInfo)
 {
+    if (m_activeConnectionsInfo == activeConnsInfo)
+        return;
+
+    const QJsonObject oldWirelessInfo = activeWirelessConnectionInfo();
+
     m_activeConnectionsInfo = activeConnsInfo;
 
-    if (activeWirelessConnectionInfo().isEmpty()) {
-        m_activeApInfo = QJsonObject();
-        Q_EMIT activeApInfoChanged(m_activeApInfo);
-    } else {
-        setActiveApBySsid(activeApSsidByActiveConnUuid(activeWirelessConnUuid()));
+    const QJsonObject &wirelessInfo = activeWirelessConnectionInfo();
+    if (wirelessInfo != oldWirelessInfo) {
+        setActiveApBySsid(wirelessInfo.isEmpty() ? QString() : activeApSsidByActiveConnUuid(activeWirelessConnUuid()));
+        Q_EMIT activeWirelessConnectionInfoChanged(wirelessInfo);
     }
 
-    Q_EMIT activeWirelessConnectionInfoChanged(activeWirelessConnectionInfo());
     Q_EMIT activeConnectionsInfoChanged(m_activeConnectionsInfo);
 }
 
 void WirelessDevice::setActiveHotspotInfo(const QJsonObject &hotspotInfo)
 {
+    if (m_activeHotspotInfo == hotspotInfo)
+        return;
+
     const bool changed = m_activeHotspotInfo.isEmpty() != hotspotInfo.isEmpty();
 
     m_activeHotspotInfo = hotspotInfo;
@@ -230,37 +604,44 @@ void WirelessDevice::setActiveHotspotInfo(const QJsonObject &hotspotInfo)
 
 void WirelessDevice::setActiveApBySsid(const QString &ssid)
 {
-    if (m_apsMap.size() > 0) {
-        // get the use same ssid Aps
-        QList<QJsonObject> sameSsidAps;
-        for (const auto &ap : m_apsMap.values()) {
-            if (ap.value("Ssid").toString() == ssid) {
-                sameSsidAps.append(ap);
-            }
-        }
-
-        // set active Ap by strength
-        if (sameSsidAps.size() > 0) {
-            for (const auto &ap : sameSsidAps) {
-                if (activeApStrength() < ap.value("Strength").toInt()) {
-                    m_activeApInfo = ap;
-                    Q_EMIT apInfoChanged(m_activeApInfo);
-                }
-            }
-            Q_EMIT activeApInfoChanged(m_activeApInfo);
-        }
-    }
+    // 同名 AP 中信号最强的一个已在 m_strongestPaths 中维护, 这里只需要切换查找的 SSID
+    m_activeSsid = ssid;
+    updateActiveAp();
 }
 
 void WirelessDevice::setConnections(const QList<QJsonObject> &connections)
 {
+    if (m_connections == connections)
+        return;
+
     m_connections = connections;
 
+    QSet<QString> knownSsids;
+    for (const QJsonObject &conn : m_connections) {
+        const QString &ssid = conn.value("Ssid").toString();
+        if (!ssid.isEmpty())
+            knownSsids.insert(ssid);
+    }
+
+    // 只有新保存或被删除的网络对应的 AP 需要调整排名
+    QSet<QString> toggled = knownSsids;
+    toggled.subtract(m_knownSsids);
+    toggled.unite(QSet<QString>(m_knownSsids).subtract(knownSsids));
+    m_knownSsids = knownSsids;
+
+    for (const QString &ssid : toggled) {
+        for (const QString &path : m_ssidPaths.value(ssid))
+            rankAP(m_apsMap.value(path), m_apRecords.value(path));
+    }
+
     Q_EMIT connectionsChanged(m_connections);
 }
 
 void WirelessDevice::setHotspotConnections(const QList<QJsonObject> &hotspotConnections)
 {
+    if (m_hotspotConnections == hotspotConnections)
+        return;
+
     m_hotspotConnections = hotspotConnections;
 
     Q_EMIT hostspotConnectionsChanged(m_hotspotConnections);
@@ -282,36 +663,5 @@ QString WirelessDevice::activeApSsidByActiveConnUuid(const QString &activeConnUu
 
 void WirelessDevice::WirelessUpdate(const QJsonValue &WirelessList)
 {
-    //临时变量保存当前全部无限网络状态使用
-    QMap<QString, QJsonObject> PathDatas;
-    QJsonArray WirelessDatas = WirelessList.toArray();
-    for (QJsonValue data : WirelessDatas) {
-        //数据为空则进行下一个循环
-        if (data.isNull()) continue;
-        //数据转换
-        QJsonObject apInfo = data.toObject();
-        //当不存在两个Key的时候,则进行下一个循环
-        if (!apInfo.contains(WIRELESS_PATH) && !apInfo.contains(WIRELESS_STRENGTH)) continue;
-
-        QString Path = apInfo.value(WIRELESS_PATH).toString();
-        //修改了的会直接更新,没有的会直接插入
-        PathDatas.insert(Path,apInfo);  
-    }
-
-    //由于改变和增加,都是调用updateAPInfo，所以可以直接将改变了的全部直接发送出去
-    for (QString Pathkey : PathDatas.keys()) {
-        QString apInfo = QString(QJsonDocument(PathDatas.value(Pathkey)).toJson());
-        //这一步会根据当前有的做修改，没有的会加上,如果有的则会更新
-        m_ssidDatas.insert(Pathkey, apInfo);
-        this->updateAPInfo(apInfo);
-    }
-    //获取相同id中信号最大值
-    setActiveApBySsid(activeApSsidByActiveConnUuid(activeWirelessConnUuid()));
-    for (QString PathKey : m_ssidDatas.keys()) {
-        if (!PathDatas.contains(PathKey)) {
-            this->deleteAP(m_ssidDatas.value(PathKey));
-            m_ssidDatas.remove(PathKey);
-        }
-    }
-    PathDatas.clear();
+    applyAPList(WirelessList.toArray());
 }
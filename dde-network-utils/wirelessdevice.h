@@ -27,14 +27,21 @@
 #define WIRELESSDEVICE_H
 
 #include "networkdevice.h"
+#include "networkrecord.h"
+#include "accesspointranking.h"
 
 #include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
 #include <QJsonArray>
 
 #include <com_deepin_daemon_network.h>
 
 using NetworkInter = com::deepin::daemon::Network;
 
+class QTimer;
+
 namespace dde {
 
 namespace network {
@@ -43,7 +50,21 @@ class WirelessDevice : public NetworkDevice
 {
     Q_OBJECT
 
+    friend class NetworkModel;
+
 public:
+    // AP 信息中发生变化的字段
+    enum AccessPointField
+    {
+        NoField         = 0x0,
+        StrengthField   = 0x1,
+        SecurityField   = 0x2,
+        FrequencyField  = 0x4,
+        SsidField       = 0x8,
+        OtherField      = 0x10,
+    };
+    Q_DECLARE_FLAGS(AccessPointFields, AccessPointField)
+
     explicit WirelessDevice(const QJsonObject &info, QObject *parent = nullptr);
 
     bool supportHotspot() const;
@@ -63,17 +84,54 @@ public:
     const QList<QJsonObject> hotspotConnections() const { return m_hotspotConnections; }
 
     const QJsonArray apList() const;
+    const QList<AccessPointRecord> apRecords() const { return m_apRecords.values(); }
+    const AccessPointRecord apRecord(const QString &apPath) const { return m_apRecords.value(apPath); }
+    // 按 已保存的网络 > 信号强度 > SSID 排好序的 AP 列表
+    const QJsonArray rankedApList() const;
+    inline int apRank(const QString &apPath) const { return m_ranking.indexOf(apPath); }
+    inline const QJsonObject rankedAp(int row) const { return m_apsMap.value(m_ranking.pathAt(row)); }
+    // 按 SSID 合并后的网络列表, 每个 SSID 只保留一项
+    const QList<QJsonObject> networks() const { return m_networks.values(); }
+    const QJsonObject network(const QString &ssid) const { return m_networks.value(ssid); }
     inline const QJsonObject activeApInfo() const { return m_activeApInfo; }
     inline const QString activeApSsid() const { return m_activeApInfo.value("Ssid").toString(); }
     inline const QString activeApPath() const { return m_activeApInfo.value("Path").toString(); }
     inline int activeApStrength() const { return m_activeApInfo.value("Strength").toInt(); }
     void updateWirlessAp();
+
+    // 信号强度的平滑系数(EWMA), 1 表示不做平滑, 默认为 1.
+    // 平滑后的值只在收到新数据时向实际值靠拢, 后端数据没有变化时会停留在中间值
+    inline double strengthSmoothing() const { return m_strengthSmoothing; }
+    void setStrengthSmoothing(double alpha);
+    // 对外信号强度的滞回区间, 平滑后的变化小于该值时保持不变, 默认为 0
+    inline int strengthHysteresis() const { return m_strengthHysteresis; }
+    void setStrengthHysteresis(int hysteresis);
+    // 同一个 AP 只有信号强度变化时两次通知的最小间隔(毫秒), 0 表示不限制,
+    // 间隔内的变化只保留最新的一次, 在间隔结束时通知
+    inline int apUpdateInterval() const { return m_apUpdateInterval; }
+    void setApUpdateInterval(int msec);
+    // 未经处理的信号强度, 用于诊断
+    int rawApStrength(const QString &apPath) const;
+    inline quint64 suppressedApUpdateCount() const { return m_suppressedApUpdateCount; }
+    // 扫描结果中缺失的 AP 保留的时间(毫秒), 0 表示立即移除
+    inline int apExpiry() const { return m_apExpiry; }
+    void setApExpiry(int msec);
+    // AP 最近一次出现在扫描结果中的时间, 以设备创建时为起点(毫秒), 不存在时返回 -1
+    qint64 apLastSeen(const QString &apPath) const;
     void WirelessUpdate(const QJsonValue &WirelessData); //该接口给networkmodel使用
     
 Q_SIGNALS:
     void apAdded(const QJsonObject &apInfo) const;
     void apInfoChanged(const QJsonObject &apInfo) const;
+    void apFieldsChanged(const QJsonObject &apInfo, AccessPointFields fields) const;
     void apRemoved(const QJsonObject &apInfo) const;
+    // 排序位置的变化, to 为移动完成后所在的位置
+    void apRankInserted(const QJsonObject &apInfo, int row) const;
+    void apRankRemoved(const QJsonObject &apInfo, int row) const;
+    void apMoved(const QJsonObject &apInfo, int from, int to) const;
+    void networkAdded(const QJsonObject &network) const;
+    void networkChanged(const QJsonObject &network) const;
+    void networkRemoved(const QJsonObject &network) const;
     void activeApInfoChanged(const QJsonObject &activeApInfo) const;
     void activeWirelessConnectionInfoChanged(const QJsonObject &connInfo) const;
     void activeConnectionsChanged(const QList<QJsonObject> &activeConns) const;
@@ -84,6 +142,8 @@ Q_SIGNALS:
     void activateAccessPointFailed(const QString &apPath, const QString &uuid);
     void connectionsChanged(const QList<QJsonObject> &connections) const;
     void hostspotConnectionsChanged(const QList<QJsonObject> &connections) const;
+    // 扫描由 NetworkWorker 统一发起, 设备自身不持有 DBus 代理
+    void wirelessScanRequested() const;
 
 public Q_SLOTS:
     void setAPList(const QString &apList);
@@ -96,7 +156,21 @@ public Q_SLOTS:
     void setConnections(const QList<QJsonObject> &connections);
     void setHotspotConnections(const QList<QJsonObject> &hotspotConnections);
 
+private Q_SLOTS:
+    void sweepExpiredAPs();
+    void flushThrottledAPs();
+
 private:
+    void applyAPList(const QJsonArray &apArray);
+    void markAPsCached();
+    void insertAP(const QJsonObject &rawAp);
+    void applyAP(const QJsonObject &ap);
+    void removeAP(const QString &path);
+    void indexAP(const AccessPointRecord &record);
+    void unindexAP(const AccessPointRecord &record);
+    void rankAP(const QJsonObject &ap, const AccessPointRecord &record);
+    void updateNetwork(const QString &ssid);
+    void updateActiveAp();
     QString activeApSsidByActiveConnUuid(const QString &activeWirelessConnUuid);
 
 private:
@@ -105,13 +179,48 @@ private:
     QJsonObject m_activeApInfo;
     QJsonObject m_activeHotspotInfo;
     QMap<QString, QJsonObject> m_apsMap;
+    QMap<QString, AccessPointRecord> m_apRecords;
+    // SSID 到同名 AP 路径的索引, 以及每个 SSID 中信号最强的 AP
+    QHash<QString, QSet<QString>> m_ssidPaths;
+    QHash<QString, QString> m_strongestPaths;
+    QString m_activeSsid;
+    QMap<QString, QJsonObject> m_networks;
+    QSet<QString> m_knownSsids;
+    AccessPointRanking m_ranking;
     QList<QJsonObject> m_connections;
     QList<QJsonObject> m_hotspotConnections;
-    QMap<QString,QString> m_ssidDatas;
-
-    NetworkInter m_networkInter;
+    mutable QJsonArray m_apList;
+    mutable bool m_apListDirty;
+    bool m_batchUpdating;
+
+    struct StrengthState
+    {
+        int raw = 0;
+        int strength = 0;
+        double average = 0;
+        qint64 updated = 0;
+        qint64 lastSeen = 0;
+        // 最近一次出现在哪一次完整的 AP 列表中
+        quint64 listSerial = 0;
+        // 从缓存恢复后还没有出现在实时数据中
+        bool cached = false;
+    };
+    QHash<QString, StrengthState> m_strengthStates;
+    double m_strengthSmoothing;
+    int m_strengthHysteresis;
+    int m_apUpdateInterval;
+    quint64 m_suppressedApUpdateCount;
+    QElapsedTimer m_apClock;
+    int m_apExpiry;
+    quint64 m_apListSerial;
+    QTimer *m_expiryTimer;
+    // 因通知频率限制而推迟的 AP 数据
+    QHash<QString, QJsonObject> m_throttledAps;
+    QTimer *m_throttleTimer;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(WirelessDevice::AccessPointFields)
+
 }
 
 }
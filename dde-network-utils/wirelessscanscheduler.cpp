@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wirelessscanscheduler.h"
+
+#include <QTimer>
+
+// 合并同时到达的扫描请求的时间窗口
+#define ScanCoalesceInterval 100
+// NetworkManager 本身也会拒绝过于频繁的扫描, 最小间隔与之保持一致
+#define DefaultMinScanInterval (10 * 1000)
+#define DefaultMaxScanInterval (2 * 60 * 1000)
+
+namespace dde {
+
+namespace network {
+
+WirelessScanScheduler::WirelessScanScheduler(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_minInterval(DefaultMinScanInterval)
+    , m_maxInterval(DefaultMaxScanInterval)
+    , m_interval(DefaultMinScanInterval)
+    , m_lastScan(-1)
+    , m_scanStarted(-1)
+    , m_apSetChanged(false)
+    , m_periodic(false)
+    , m_hasDevices(false)
+    , m_requestPending(false)
+    , m_requestCount(0)
+    , m_scanCount(0)
+    , m_finishedCount(0)
+    , m_lastLatency(-1)
+    , m_totalLatency(0)
+{
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &WirelessScanScheduler::startScan);
+
+    m_clock.start();
+}
+
+void WirelessScanScheduler::setMinInterval(int msec)
+{
+    m_minInterval = qMax(0, msec);
+    m_maxInterval = qMax(m_minInterval, m_maxInterval);
+    m_interval = qBound(m_minInterval, m_interval, m_maxInterval);
+}
+
+void WirelessScanScheduler::setMaxInterval(int msec)
+{
+    m_maxInterval = qMax(m_minInterval, msec);
+    m_interval = qBound(m_minInterval, m_interval, m_maxInterval);
+}
+
+void WirelessScanScheduler::setPeriodicScanEnabled(bool enabled)
+{
+    if (m_periodic == enabled)
+        return;
+
+    m_periodic = enabled;
+
+    // 关闭时取消尚未执行的定期扫描, 已经收到的扫描请求不受影响
+    if (!m_periodic && !m_requestPending)
+        m_timer->stop();
+
+    schedulePeriodicScan();
+}
+
+qint64 WirelessScanScheduler::averageScanLatency() const
+{
+    return m_finishedCount ? qint64(m_totalLatency / m_finishedCount) : -1;
+}
+
+void WirelessScanScheduler::requestScan()
+{
+    ++m_requestCount;
+
+    // 界面发起的扫描不等待退避的间隔, 但与上一次扫描仍至少间隔 minInterval()
+    qint64 delay = ScanCoalesceInterval;
+    if (m_lastScan >= 0)
+        delay = qMax(delay, m_lastScan + m_minInterval - m_clock.elapsed());
+
+    m_requestPending = true;
+
+    // 已经安排了不晚于此的扫描, 本次请求直接合并进去
+    if (m_timer->isActive() && m_timer->remainingTime() <= delay)
+        return;
+
+    schedule(delay);
+}
+
+void WirelessScanScheduler::requestBackgroundScan()
+{
+    ++m_requestCount;
+
+    qint64 delay = ScanCoalesceInterval;
+    if (m_lastScan >= 0)
+        delay = qMax(delay, m_lastScan + m_interval - m_clock.elapsed());
+
+    m_requestPending = true;
+
+    // 已经安排了不晚于此的扫描, 本次请求直接合并进去
+    if (m_timer->isActive() && m_timer->remainingTime() <= delay)
+        return;
+
+    schedule(delay);
+}
+
+void WirelessScanScheduler::expedite()
+{
+    // 漫游或断开连接后周围的 AP 很可能已经变化, 不再等待退避的间隔
+    m_interval = m_minInterval;
+    m_lastScan = -1;
+    m_requestPending = true;
+
+    if (!m_timer->isActive() || m_timer->remainingTime() > ScanCoalesceInterval)
+        schedule(ScanCoalesceInterval);
+}
+
+void WirelessScanScheduler::onScanFinished()
+{
+    // 没有进行中的扫描
+    if (m_scanStarted < 0)
+        return;
+
+    m_lastLatency = m_clock.elapsed() - m_scanStarted;
+    m_totalLatency += m_lastLatency;
+    ++m_finishedCount;
+    m_scanStarted = -1;
+
+    // AP 列表没有变化说明环境稳定, 加大下一次扫描的间隔
+    if (!m_apSetChanged)
+        m_interval = qMin(m_interval * 2, m_maxInterval);
+
+    schedulePeriodicScan();
+}
+
+void WirelessScanScheduler::onAccessPointSetChanged()
+{
+    m_apSetChanged = true;
+    m_interval = m_minInterval;
+    schedulePeriodicScan();
+}
+
+void WirelessScanScheduler::onActiveAccessPointChanged(const QString &devPath, const QString &apPath)
+{
+    const QString oldApPath = m_activeAps.value(devPath);
+    if (oldApPath == apPath)
+        return;
+
+    if (apPath.isEmpty())
+        m_activeAps.remove(devPath);
+    else
+        m_activeAps.insert(devPath, apPath);
+
+    // 首次连接不需要额外扫描, 只有漫游或断开时才提前扫描
+    if (!oldApPath.isEmpty())
+        expedite();
+}
+
+void WirelessScanScheduler::onWirelessDevicesChanged(const QStringList &devPaths)
+{
+    const bool hadDevices = m_hasDevices;
+    m_hasDevices = !devPaths.isEmpty();
+    if (!hadDevices)
+        schedulePeriodicScan();
+
+    // 已移除的设备不再记录其连接的 AP, 同一路径的设备重新出现时不应被当作漫游
+    for (auto it(m_activeAps.begin()); it != m_activeAps.end();) {
+        if (devPaths.contains(it.key()))
+            ++it;
+        else
+            it = m_activeAps.erase(it);
+    }
+}
+
+void WirelessScanScheduler::startScan()
+{
+    m_lastScan = m_scanStarted = m_clock.elapsed();
+    m_apSetChanged = false;
+    m_requestPending = false;
+    ++m_scanCount;
+
+    // 没有收到扫描完成的通知时, 最晚在最大间隔后继续定期扫描
+    if (m_periodic && m_hasDevices)
+        schedule(m_maxInterval);
+
+    Q_EMIT scanRequested();
+}
+
+void WirelessScanScheduler::schedule(qint64 delay)
+{
+    m_timer->start(int(qMax(qint64(0), delay)));
+}
+
+void WirelessScanScheduler::schedulePeriodicScan()
+{
+    if (!m_periodic || !m_hasDevices)
+        return;
+
+    qint64 delay = ScanCoalesceInterval;
+    if (m_lastScan >= 0)
+        delay = qMax(delay, m_lastScan + m_interval - m_clock.elapsed());
+
+    // 已经安排了更早的扫描时不推迟
+    if (m_timer->isActive() && m_timer->remainingTime() <= delay)
+        return;
+
+    schedule(delay);
+}
+
+}   // namespace network
+
+}   // namespace dde
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2011 ~ 2021 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WIRELESSSCANSCHEDULER_H
+#define WIRELESSSCANSCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+#include <QElapsedTimer>
+
+class QTimer;
+
+namespace dde {
+
+namespace network {
+
+/**
+ * @brief WirelessScanScheduler 统一调度无线扫描请求:
+ * 短时间内的多个请求合并为一次扫描, 除漫游及断开连接外, 任意两次扫描至少间隔 minInterval().
+ * 界面发起的请求(requestScan)不等待退避的间隔; 设备发起的请求(requestBackgroundScan)
+ * 及开启定期扫描后的扫描与上一次扫描至少间隔 currentInterval(),
+ * AP 列表持续不变时间隔逐步加倍, AP 列表变化、漫游或断开连接时恢复为最小间隔
+ */
+class WirelessScanScheduler : public QObject
+{
+    Q_OBJECT
+
+    friend class NetworkWorker;
+
+public:
+    explicit WirelessScanScheduler(QObject *parent = nullptr);
+
+    inline int minInterval() const { return m_minInterval; }
+    void setMinInterval(int msec);
+    inline int maxInterval() const { return m_maxInterval; }
+    void setMaxInterval(int msec);
+    inline int currentInterval() const { return m_interval; }
+    // 是否按 currentInterval() 定期扫描, 只在存在无线设备时生效
+    inline bool periodicScanEnabled() const { return m_periodic; }
+    void setPeriodicScanEnabled(bool enabled);
+
+    inline quint64 requestCount() const { return m_requestCount; }
+    inline quint64 scanCount() const { return m_scanCount; }
+    // 从发起扫描到收到扫描结果的耗时(毫秒), 没有数据时为 -1
+    inline qint64 lastScanLatency() const { return m_lastLatency; }
+    qint64 averageScanLatency() const;
+
+Q_SIGNALS:
+    void scanRequested() const;
+
+public Q_SLOTS:
+    void requestScan();
+    void requestBackgroundScan();
+    void expedite();
+    // 由本调度器发起的扫描已经完成, 后端自行发起的扫描不应调用
+    void onScanFinished();
+    void onAccessPointSetChanged();
+    // apPath 为设备实际关联的 AP, 未连接时为空
+    void onActiveAccessPointChanged(const QString &devPath, const QString &apPath);
+    void onWirelessDevicesChanged(const QStringList &devPaths);
+
+private Q_SLOTS:
+    void startScan();
+
+private:
+    void schedule(qint64 delay);
+    void schedulePeriodicScan();
+
+private:
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+    int m_minInterval;
+    int m_maxInterval;
+    int m_interval;
+    qint64 m_lastScan;
+    qint64 m_scanStarted;
+    bool m_apSetChanged;
+    bool m_periodic;
+    bool m_hasDevices;
+    // 当前安排的扫描中包含请求发起的扫描, 而不只是定期扫描
+    bool m_requestPending;
+    QHash<QString, QString> m_activeAps;
+
+    quint64 m_requestCount;
+    quint64 m_scanCount;
+    quint64 m_finishedCount;
+    qint64 m_lastLatency;
+    qint64 m_totalLatency;
+};
+
+}   // namespace network
+
+}   // namespace dde
+
+#endif // WIRELESSSCANSCHEDULER_H
@@ -0,0 +1,17 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <gtest/gtest.h>
+
+#include <QDebug>
+#include <QString>
+
+// 输出一项基准测试的结果, 同时记录到 --gtest_output 生成的报告中.
+// 测试以 -O0 的覆盖率模式编译, 耗时只用来对比, 不作为断言的依据
+inline void reportBenchmark(const char *name, double value, const char *unit)
+{
+    testing::Test::RecordProperty(name, QString::number(value).toStdString());
+    qDebug().noquote() << QString("%1: %2 %3").arg(name).arg(value).arg(unit);
+}
+
+#endif // BENCHMARK_H
@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 
+#include "networkmodel.h"
+
 #include <QCoreApplication>
 #include <QDebug>
+#include <QStandardPaths>
 
 #define private public
 
@@ -9,6 +12,8 @@ int main(int argc, char *argv[])
 {
     qputenv("QT_QPA_PLATFORM", "offscreen");
     QCoreApplication app(argc,argv);
+    // NetworkModel 默认开启磁盘缓存, 测试中不能读写用户目录下的缓存文件
+    QStandardPaths::setTestModeEnabled(true);
     qDebug() << "start dde-network-utils test cases ..............";
     ::testing::InitGoogleTest(&argc, argv);
     int ret = RUN_ALL_TESTS();
@@ -0,0 +1,84 @@
+#ifndef TESTDATA_H
+#define TESTDATA_H
+
+#include <QString>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+// 各个测试共用的模拟数据, 格式与 com.deepin.daemon.Network 的属性一致
+
+// count 个无线连接, 第 i 个的 Uuid/Id/Path/Ssid 均以 i 结尾
+inline QString syntheticConnections(int count)
+{
+    QJsonArray wireless;
+    for (int i = 0; i < count; ++i) {
+        QJsonObject conn;
+        conn.insert("Uuid", QString("uuid-%1").arg(i));
+        conn.insert("Id", QString("conn-%1").arg(i));
+        conn.insert("Path", QString("/org/freedesktop/NetworkManager/Settings/%1").arg(i));
+        conn.insert("Ssid", QString("ssid-%1").arg(i));
+        conn.insert("HwAddress", QString());
+        wireless.append(conn);
+    }
+
+    QJsonObject conns;
+    conns.insert("wireless", wireless);
+
+    return QString::fromUtf8(QJsonDocument(conns).toJson(QJsonDocument::Compact));
+}
+
+// count 个设备, 路径为 Devices/i, 奇数为无线网卡, 偶数为有线网卡
+inline QString syntheticDevices(int count)
+{
+    QJsonArray wired, wireless;
+    for (int i = 0; i < count; ++i) {
+        QJsonObject dev;
+        dev.insert("Path", QString("/org/freedesktop/NetworkManager/Devices/%1").arg(i));
+        dev.insert("Interface", QString("dev%1").arg(i));
+        dev.insert("HwAddress", QString("00:11:22:33:44:%1").arg(i, 2, 16, QChar('0')));
+        dev.insert("ClonedAddress", i % 4 ? QString() : QString("02:11:22:33:44:%1").arg(i, 2, 16, QChar('0')));
+        dev.insert("Managed", true);
+        dev.insert("State", 30);
+        if (i % 2) {
+            dev.insert("SupportHotspot", true);
+            wireless.append(dev);
+        } else {
+            wired.append(dev);
+        }
+    }
+
+    QJsonObject devices;
+    devices.insert("wired", wired);
+    devices.insert("wireless", wireless);
+
+    return QString::fromUtf8(QJsonDocument(devices).toJson(QJsonDocument::Compact));
+}
+
+// round 用来模拟每次扫描时信号强度的波动, 每 3 个 AP 共用一个 SSID
+inline QJsonArray syntheticAccessPoints(int count, int round = 0)
+{
+    QJsonArray aps;
+    for (int i = 0; i < count; ++i) {
+        QJsonObject ap;
+        ap.insert("Path", QString("/org/freedesktop/NetworkManager/AccessPoint/%1").arg(i));
+        ap.insert("Ssid", QString("ssid-%1").arg(i / 3));
+        ap.insert("Strength", (i * 7 + round * 13) % 100);
+        ap.insert("Secured", i % 2 == 0);
+        ap.insert("Frequency", i % 2 ? 2412 : 5180);
+        aps.append(ap);
+    }
+
+    return aps;
+}
+
+// 以设备路径为键的 AP 列表, 即 WirelessAccessPoints 属性的格式
+inline QString syntheticAccessPointsPayload(const QString &devPath, int count, int round = 0)
+{
+    QJsonObject payload;
+    payload.insert(devPath, syntheticAccessPoints(count, round));
+
+    return QString::fromUtf8(QJsonDocument(payload).toJson(QJsonDocument::Compact));
+}
+
+#endif // TESTDATA_H
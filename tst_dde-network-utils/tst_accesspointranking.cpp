@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include "accesspointranking.h"
+#include "benchmark.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+using namespace dde::network;
+
+TEST(TstAccessPointRanking, order)
+{
+    AccessPointRanking ranking;
+
+    EXPECT_EQ(ranking.insert("/ap/1", "b", 50, false), 0);
+    EXPECT_EQ(ranking.insert("/ap/2", "a", 50, false), 0);
+    EXPECT_EQ(ranking.insert("/ap/3", "c", 80, false), 0);
+    // 已保存的网络总是排在前面
+    EXPECT_EQ(ranking.insert("/ap/4", "d", 10, true), 0);
+
+    EXPECT_EQ(ranking.paths(), QStringList({"/ap/4", "/ap/3", "/ap/2", "/ap/1"}));
+    EXPECT_EQ(ranking.pathAt(2), QString("/ap/2"));
+    EXPECT_EQ(ranking.indexOf("/ap/1"), 3);
+    EXPECT_EQ(ranking.indexOf("/ap/missing"), -1);
+
+    // 信号变强后移动到新的位置
+    EXPECT_EQ(ranking.insert("/ap/1", "b", 90, false), 1);
+    EXPECT_EQ(ranking.paths(), QStringList({"/ap/4", "/ap/1", "/ap/3", "/ap/2"}));
+
+    EXPECT_EQ(ranking.remove("/ap/4"), 0);
+    EXPECT_EQ(ranking.remove("/ap/4"), -1);
+    EXPECT_EQ(ranking.size(), 3);
+    EXPECT_EQ(ranking.pathAt(0), QString("/ap/1"));
+}
+
+TEST(TstAccessPointRanking, reorderBenchmark)
+{
+    const int count = 500;
+    const int updates = 20000;
+
+    AccessPointRanking ranking;
+    for (int i = 0; i < count; ++i)
+        ranking.insert(QString("/ap/%1").arg(i), QString("ssid-%1").arg(i), i % 100, false);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < updates; ++i)
+        ranking.insert(QString("/ap/%1").arg(i % count), QString("ssid-%1").arg(i % count), (i * 37) % 100, false);
+    const qint64 rankedNs = timer.nsecsElapsed();
+
+    // 对照: 每次变化后重新排序整个列表
+    QList<QPair<int, QString>> list;
+    for (int i = 0; i < count; ++i)
+        list.append(qMakePair(i % 100, QString("/ap/%1").arg(i)));
+
+    timer.restart();
+    for (int i = 0; i < updates; ++i) {
+        list[i % count].first = (i * 37) % 100;
+        // ssid-N 与 /ap/N 的先后顺序相同, 按路径比较即可
+        std::sort(list.begin(), list.end(), [](const QPair<int, QString> &a, const QPair<int, QString> &b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+    }
+    const qint64 resortNs = timer.nsecsElapsed();
+
+    QStringList resorted;
+    for (const auto &item : list)
+        resorted << item.second;
+
+    EXPECT_EQ(ranking.size(), count);
+    EXPECT_EQ(ranking.paths(), resorted);
+
+    reportBenchmark("incrementalRanking", rankedNs / 1000000, "ms");
+    reportBenchmark("fullResort", resortNs / 1000000, "ms");
+}
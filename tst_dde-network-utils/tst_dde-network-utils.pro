@@ -21,12 +21,22 @@ include(../dde-network-utils/src.pri)
 
 SOURCES += \
     main.cpp \
+    tst_accesspointranking.cpp \
     tst_connecttivitychecker.cpp \
+    tst_latencyhistogram.cpp \
+    tst_networkcache.cpp \
     tst_networkdevice.cpp \
     tst_networkmodel.cpp \
+    tst_networkrecord.cpp \
     tst_networkworker.cpp \
     tst_wireddevice.cpp \
-    tst_wirelessdevice.cpp
+    tst_wirelessdevice.cpp \
+    tst_wirelessscanscheduler.cpp
+
+HEADERS += \
+    benchmark.h \
+    testdata.h
+
 INCLUDEPATH += ../dde-network-utils
 
 RESOURCES +=
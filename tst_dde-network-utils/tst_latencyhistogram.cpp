@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+
+#include "latencyhistogram.h"
+
+using namespace dde::network;
+
+TEST(TstLatencyHistogram, buckets)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.count(), 0);
+    EXPECT_EQ(histogram.percentile(0.5), 0);
+
+    histogram.add(0);
+    histogram.add(3);
+    histogram.add(100);
+    histogram.add(1000000);
+
+    EXPECT_EQ(histogram.count(), 4);
+    EXPECT_EQ(histogram.min(), 0);
+    EXPECT_EQ(histogram.max(), 1000000);
+    EXPECT_EQ(histogram.bucket(0), 1);
+    // 3 落在 [2, 4)
+    EXPECT_EQ(histogram.bucket(1), 1);
+    // 100 落在 [64, 128)
+    EXPECT_EQ(histogram.bucket(6), 1);
+    // 超出范围的值都在最后一个区间
+    EXPECT_EQ(histogram.bucket(LatencyHistogram::BucketCount - 1), 1);
+
+    EXPECT_EQ(histogram.percentile(0.5), 4);
+    EXPECT_EQ(histogram.percentile(0.75), 128);
+    EXPECT_EQ(histogram.percentile(1), 1000000);
+
+    histogram.clear();
+    EXPECT_EQ(histogram.count(), 0);
+    EXPECT_EQ(histogram.mean(), 0);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include "networkcache.h"
+#include "networkmodel.h"
+#include "wirelessdevice.h"
+#include "testdata.h"
+#include "benchmark.h"
+
+#include <QFile>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+
+using namespace dde::network;
+
+TEST(TstNetworkCache, saveAndLoad)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString fileName = dir.filePath("network.cache");
+
+    {
+        NetworkCache cache(fileName);
+        EXPECT_FALSE(cache.load());
+        cache.store(NetworkSnapshot::DevicesPayload, syntheticDevices(2).toUtf8());
+        cache.store(NetworkSnapshot::ConnectionsPayload, syntheticConnections(10).toUtf8());
+        // 活动连接不会被缓存
+        cache.store(NetworkSnapshot::ActiveConnectionsPayload, "{}");
+        ASSERT_TRUE(cache.save());
+    }
+
+    NetworkCache cache(fileName);
+    ASSERT_TRUE(cache.load());
+    EXPECT_EQ(cache.payload(NetworkSnapshot::DevicesPayload), syntheticDevices(2).toUtf8());
+    EXPECT_EQ(cache.payload(NetworkSnapshot::ConnectionsPayload), syntheticConnections(10).toUtf8());
+    EXPECT_TRUE(cache.payload(NetworkSnapshot::ActiveConnectionsPayload).isEmpty());
+    EXPECT_TRUE(cache.payload(NetworkSnapshot::AccessPointsPayload).isEmpty());
+}
+
+TEST(TstNetworkCache, rejectCorruptFile)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString fileName = dir.filePath("network.cache");
+
+    {
+        NetworkCache cache(fileName);
+        cache.store(NetworkSnapshot::ConnectionsPayload, syntheticConnections(10).toUtf8());
+        ASSERT_TRUE(cache.save());
+    }
+
+    QFile file(fileName);
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    file.resize(file.size() / 2);
+    file.close();
+
+    NetworkCache truncated(fileName);
+    EXPECT_FALSE(truncated.load());
+
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("not a cache file");
+    file.close();
+
+    NetworkCache garbage(fileName);
+    EXPECT_FALSE(garbage.load());
+}
+
+TEST(TstNetworkCache, warmStart)
+{
+    // 缓存默认开启, 也可以在构造时针对单个实例关闭
+    {
+        NetworkModel model(nullptr, false);
+        EXPECT_FALSE(model.cacheEnabled());
+    }
+
+    // syntheticDevices(2) 中唯一的无线网卡
+    const QString wirelessPath("/org/freedesktop/NetworkManager/Devices/1");
+
+    {
+        NetworkCache cache(NetworkCache::defaultFileName());
+        cache.store(NetworkSnapshot::DevicesPayload, syntheticDevices(2).toUtf8());
+        cache.store(NetworkSnapshot::ConnectionsPayload, syntheticConnections(200).toUtf8());
+        cache.store(NetworkSnapshot::AccessPointsPayload, syntheticAccessPointsPayload(wirelessPath, 3).toUtf8());
+        ASSERT_TRUE(cache.save());
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    NetworkModel *model = new NetworkModel;
+    const qint64 constructMs = timer.elapsed();
+
+    EXPECT_TRUE(model->cacheEnabled());
+    EXPECT_GE(model->cacheLoadTime(), 0);
+    EXPECT_EQ(model->devices().size(), 2);
+    EXPECT_EQ(model->wireless().size(), 200);
+
+    // 实时数据与缓存相同时不会重复处理
+    const quint64 processed = model->processedUpdateCount();
+    QMetaObject::invokeMethod(model, "onConnectionListChanged", Q_ARG(QString, syntheticConnections(200)));
+    EXPECT_EQ(model->processedUpdateCount(), processed);
+
+    // 从缓存恢复的 AP 在第一份实时数据中缺失时直接移除, 不等待过期
+    NetworkDevice *dev = nullptr;
+    for (NetworkDevice *d : model->devices()) {
+        if (d->path() == wirelessPath)
+            dev = d;
+    }
+    ASSERT_TRUE(dev);
+    ASSERT_EQ(dev->type(), NetworkDevice::Wireless);
+    const WirelessDevice *wireless = static_cast<WirelessDevice *>(dev);
+    EXPECT_EQ(wireless->apList().size(), 3);
+
+    // 缓存中的设备状态已经过时, 收到实时数据之前保持未知
+    EXPECT_EQ(dev->status(), NetworkDevice::Unknown);
+    QMetaObject::invokeMethod(model, "onDevicesChanged", Q_ARG(QString, syntheticDevices(2)));
+    EXPECT_EQ(dev->status(), NetworkDevice::Disconnected);
+
+    QMetaObject::invokeMethod(model, "WirelessAccessPointsChanged", Q_ARG(QString, syntheticAccessPointsPayload(wirelessPath, 1)));
+    EXPECT_EQ(wireless->apList().size(), 1);
+
+    reportBenchmark("modelReadyFromCache", constructMs, "ms");
+    reportBenchmark("cacheRestore", model->cacheLoadTime(), "ms");
+
+    delete model;
+    QFile::remove(NetworkCache::defaultFileName());
+}
@@ -3,6 +3,7 @@
 #include "networkdevice.h"
 
 #include <QMimeData>
+#include <QJsonObject>
 
 using namespace dde::network;
 
@@ -28,3 +29,114 @@ TEST_F(TstNetworkDevice, coverageTest)
 {
 
 }
+
+class StatusDevice : public NetworkDevice
+{
+public:
+    StatusDevice() : NetworkDevice(NetworkDevice::Wired, QJsonObject {{"Path", "/org/freedesktop/NetworkManager/Devices/1"}}) {}
+
+    void setStatus(DeviceStatus status)
+    {
+        QMetaObject::invokeMethod(this, "setDeviceStatus", Q_ARG(int, status));
+    }
+};
+
+TEST_F(TstNetworkDevice, statusHistory)
+{
+    StatusDevice device;
+
+    device.setStatus(NetworkDevice::Config);
+    device.setStatus(NetworkDevice::IpConfig);
+    device.setStatus(NetworkDevice::Failed);
+    EXPECT_FALSE(device.obtainIpFailed());
+    device.setStatus(NetworkDevice::Disconnected);
+
+    // 只保留最近的 4 个状态
+    EXPECT_EQ(device.statusQueue(), QQueue<NetworkDevice::DeviceStatus>() << NetworkDevice::Config << NetworkDevice::IpConfig
+                                                                          << NetworkDevice::Failed << NetworkDevice::Disconnected);
+    EXPECT_TRUE(device.obtainIpFailed());
+
+    const QList<NetworkDevice::StatusEntry> history = device.statusHistory();
+    ASSERT_EQ(history.size(), 4);
+    for (int i = 1; i < history.size(); ++i)
+        EXPECT_GE(history.at(i).timestamp, history.at(i - 1).timestamp);
+
+    device.setStatus(NetworkDevice::Prepare);
+    EXPECT_EQ(device.statusQueue().size(), 4);
+    EXPECT_EQ(device.statusQueue().last(), NetworkDevice::Prepare);
+    EXPECT_FALSE(device.obtainIpFailed());
+}
+
+TEST_F(TstNetworkDevice, phaseLatency)
+{
+    StatusDevice device;
+
+    device.setStatus(NetworkDevice::Prepare);
+    device.setStatus(NetworkDevice::Config);
+    device.setStatus(NetworkDevice::NeedAuth);
+    device.setStatus(NetworkDevice::IpConfig);
+    device.setStatus(NetworkDevice::Activated);
+
+    EXPECT_EQ(device.phaseLatency(NetworkDevice::PreparePhase).count(), 1);
+    EXPECT_EQ(device.phaseLatency(NetworkDevice::ConfigPhase).count(), 1);
+    EXPECT_EQ(device.phaseLatency(NetworkDevice::IpConfigPhase).count(), 1);
+    EXPECT_EQ(device.phaseLatency(NetworkDevice::FailurePhase).count(), 0);
+
+    // 认证失败: 只统计失败的耗时
+    device.setStatus(NetworkDevice::Prepare);
+    device.setStatus(NetworkDevice::Config);
+    device.setStatus(NetworkDevice::NeedAuth);
+    device.setStatus(NetworkDevice::Failed);
+
+    EXPECT_EQ(device.phaseLatency(NetworkDevice::PreparePhase).count(), 2);
+    EXPECT_EQ(device.phaseLatency(NetworkDevice::ConfigPhase).count(), 1);
+    EXPECT_EQ(device.phaseLatency(NetworkDevice::FailurePhase).count(), 1);
+}
+
+TEST_F(TstNetworkDevice, deviceInfoChangedFields)
+{
+    StatusDevice device;
+
+    int emitted = 0;
+    NetworkDevice::ChangedFields fields;
+    QObject::connect(&device, &NetworkDevice::deviceInfoChanged, [&](NetworkDevice::ChangedFields f) {
+        ++emitted;
+        fields = f;
+    });
+
+    QJsonObject info = device.info();
+    // 相同的数据不产生信号
+    QMetaObject::invokeMethod(&device, "updateDeviceInfo", Q_ARG(QJsonObject, info));
+    EXPECT_EQ(emitted, 0);
+
+    info.insert("HwAddress", "00:11:22:33:44:55");
+    QMetaObject::invokeMethod(&device, "updateDeviceInfo", Q_ARG(QJsonObject, info));
+    EXPECT_EQ(emitted, 1);
+    EXPECT_EQ(fields, NetworkDevice::ChangedFields(NetworkDevice::HwAddressField));
+    EXPECT_EQ(device.realHwAdr(), QString("00:11:22:33:44:55"));
+
+    info.insert("State", int(NetworkDevice::Activated));
+    info.insert("Managed", true);
+    QMetaObject::invokeMethod(&device, "updateDeviceInfo", Q_ARG(QJsonObject, info));
+    EXPECT_EQ(emitted, 2);
+    EXPECT_EQ(fields, NetworkDevice::StateField | NetworkDevice::ManagedField);
+    EXPECT_EQ(device.status(), NetworkDevice::Activated);
+
+    // 本地修改过的状态在后端重新发送相同数据时恢复, 但不产生信息变化的信号
+    device.setStatus(NetworkDevice::Failed);
+    QMetaObject::invokeMethod(&device, "updateDeviceInfo", Q_ARG(QJsonObject, info));
+    EXPECT_EQ(emitted, 2);
+    EXPECT_EQ(device.status(), NetworkDevice::Activated);
+
+    info.insert("Path", "/org/freedesktop/NetworkManager/Devices/2");
+    QMetaObject::invokeMethod(&device, "updateDeviceInfo", Q_ARG(QJsonObject, info));
+    EXPECT_EQ(emitted, 3);
+    EXPECT_EQ(fields, NetworkDevice::ChangedFields(NetworkDevice::PathField));
+    EXPECT_EQ(device.path(), QString("/org/freedesktop/NetworkManager/Devices/2"));
+
+    // 未单独缓存的字段
+    info.insert("Vendor", "Intel");
+    QMetaObject::invokeMethod(&device, "updateDeviceInfo", Q_ARG(QJsonObject, info));
+    EXPECT_EQ(emitted, 4);
+    EXPECT_EQ(fields, NetworkDevice::ChangedFields(NetworkDevice::OtherField));
+}
@@ -1,8 +1,19 @@
 #include <gtest/gtest.h>
 
 #include "networkmodel.h"
+#include "payloadparser.h"
+#include "wirelessdevice.h"
+#include "testdata.h"
+#include "benchmark.h"
 
 #include <QMimeData>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 
 using namespace dde::network;
 
@@ -11,13 +22,13 @@ class TstNetworkModel : public testing::Test
 public:
     void SetUp() override
     {
-//        obj = new NetworkModel();
+        obj = new NetworkModel(nullptr, false);
     }
 
     void TearDown() override
     {
-//        delete obj;
-//        obj = nullptr;
+        delete obj;
+        obj = nullptr;
     }
 
 public:
@@ -28,3 +39,272 @@ TEST_F(TstNetworkModel, coverageTest)
 {
 
 }
+
+TEST_F(TstNetworkModel, connectionLookupBenchmark)
+{
+    const int count = 1000;
+    QMetaObject::invokeMethod(obj, "onConnectionListChanged", Q_ARG(QString, syntheticConnections(count)));
+    ASSERT_EQ(obj->wireless().size(), count);
+
+    EXPECT_EQ(obj->connectionByUuid("uuid-42").value("Id").toString(), QString("conn-42"));
+    EXPECT_EQ(obj->connectionUuidByPath("/org/freedesktop/NetworkManager/Settings/7"), QString("uuid-7"));
+    EXPECT_EQ(obj->connectionUuidByApInfo(QJsonObject {{"Ssid", "ssid-999"}}), QString("uuid-999"));
+    EXPECT_TRUE(obj->connectionByUuid("missing").isEmpty());
+
+    // 线性查找作为对照
+    QElapsedTimer timer;
+    timer.start();
+    int found = 0;
+    const QList<QJsonObject> list = obj->wireless();
+    for (int i = 0; i < count; ++i) {
+        const QString uuid = QString("uuid-%1").arg(i);
+        for (const auto &cfg : list) {
+            if (cfg.value("Uuid").toString() == uuid) {
+                ++found;
+                break;
+            }
+        }
+    }
+    const qint64 linearNs = timer.nsecsElapsed();
+
+    timer.restart();
+    int indexed = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!obj->connectionByUuid(QString("uuid-%1").arg(i)).isEmpty())
+            ++indexed;
+    }
+    const qint64 indexedNs = timer.nsecsElapsed();
+
+    EXPECT_EQ(found, count);
+    EXPECT_EQ(indexed, count);
+    reportBenchmark("linearLookup", linearNs / 1000, "us");
+    reportBenchmark("indexedLookup", indexedNs / 1000, "us");
+}
+
+TEST_F(TstNetworkModel, connectionListDiff)
+{
+    int added = 0, removed = 0, changed = 0, listChanged = 0;
+    QObject::connect(obj, &NetworkModel::connectionAdded, [&] { ++added; });
+    QObject::connect(obj, &NetworkModel::connectionRemoved, [&] { ++removed; });
+    QObject::connect(obj, &NetworkModel::connectionChanged, [&] { ++changed; });
+    QObject::connect(obj, &NetworkModel::connectionListChanged, [&] { ++listChanged; });
+
+    const QString conns = syntheticConnections(3);
+    QMetaObject::invokeMethod(obj, "onConnectionListChanged", Q_ARG(QString, conns));
+    EXPECT_EQ(added, 3);
+    EXPECT_EQ(listChanged, 1);
+
+    // 相同的数据不应再发出任何信号
+    QMetaObject::invokeMethod(obj, "onConnectionListChanged", Q_ARG(QString, conns));
+    EXPECT_EQ(listChanged, 1);
+
+    QJsonObject data = QJsonDocument::fromJson(conns.toUtf8()).object();
+    QJsonArray wireless = data.value("wireless").toArray();
+    QJsonObject first = wireless.at(0).toObject();
+    first.insert("Id", "renamed");
+    wireless.replace(0, first);
+    wireless.removeLast();
+    data.insert("wireless", wireless);
+
+    QMetaObject::invokeMethod(obj, "onConnectionListChanged",
+                              Q_ARG(QString, QString::fromUtf8(QJsonDocument(data).toJson(QJsonDocument::Compact))));
+    EXPECT_EQ(added, 3);
+    EXPECT_EQ(changed, 1);
+    EXPECT_EQ(removed, 1);
+    EXPECT_EQ(listChanged, 2);
+}
+
+TEST_F(TstNetworkModel, payloadParseBenchmark)
+{
+    const QString payload = syntheticConnections(8000);
+    const QByteArray raw = payload.toUtf8();
+    const double mb = raw.size() / (1024.0 * 1024.0);
+    const int rounds = 10;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < rounds; ++i)
+        QJsonDocument::fromJson(payload.toUtf8());
+    const double viaString = timer.nsecsElapsed() / 1e6 / rounds / mb;
+
+    timer.restart();
+    for (int i = 0; i < rounds; ++i)
+        QJsonDocument::fromJson(raw);
+    const double viaBytes = timer.nsecsElapsed() / 1e6 / rounds / mb;
+
+    // 两种方式解析出的结果相同
+    const QJsonObject parsed = PayloadParser::parse(raw, "connections").object();
+    EXPECT_EQ(parsed, QJsonDocument::fromJson(payload.toUtf8()).object());
+    EXPECT_EQ(parsed.value("wireless").toArray().size(), 8000);
+
+    reportBenchmark("parseViaStringPerMB", viaString, "ms");
+    reportBenchmark("parseRawPerMB", viaBytes, "ms");
+}
+
+TEST_F(TstNetworkModel, skipUnchangedPayload)
+{
+    const QString conns = syntheticConnections(10);
+
+    QMetaObject::invokeMethod(obj, "onConnectionListChanged", Q_ARG(QString, conns));
+    QMetaObject::invokeMethod(obj, "onConnectionListChanged", Q_ARG(QString, conns));
+    QMetaObject::invokeMethod(obj, "onConnectionListChanged", Q_ARG(QString, syntheticConnections(11)));
+
+    EXPECT_EQ(obj->processedUpdateCount(), quint64(2));
+    EXPECT_EQ(obj->skippedUpdateCount(), quint64(1));
+    EXPECT_EQ(obj->wireless().size(), 11);
+}
+
+TEST_F(TstNetworkModel, asyncParsing)
+{
+    obj->setAsyncParsing(true);
+    ASSERT_TRUE(obj->asyncParsing());
+
+    const NetworkSnapshotPtr before = obj->snapshot();
+
+    QEventLoop loop;
+    QObject::connect(obj, &NetworkModel::connectionListChanged, &loop, &QEventLoop::quit);
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+
+    QMetaObject::invokeMethod(obj, "onConnectionListChanged", Q_ARG(QString, syntheticConnections(300)));
+    // 解析在其它线程中进行, 数据不会立即生效
+    EXPECT_TRUE(obj->wireless().isEmpty());
+
+    loop.exec();
+
+    EXPECT_EQ(obj->wireless().size(), 300);
+    EXPECT_NE(obj->snapshot(), before);
+    EXPECT_EQ(obj->snapshot()->wireless().size(), 300);
+
+    // 切换回同步模式后数据立即生效
+    obj->setAsyncParsing(false);
+    QMetaObject::invokeMethod(obj, "onConnectionListChanged", Q_ARG(QString, syntheticConnections(301)));
+    EXPECT_EQ(obj->wireless().size(), 301);
+}
+
+TEST_F(TstNetworkModel, deviceAPList)
+{
+    QMetaObject::invokeMethod(obj, "onDevicesChanged", Q_ARG(QString, syntheticDevices(4)));
+    ASSERT_EQ(obj->devices().size(), 4);
+
+    const QJsonArray aps {
+        QJsonObject {
+            {"Path", "/org/freedesktop/NetworkManager/AccessPoint/1"},
+            {"Ssid", "ssid-1"},
+            {"Strength", 50},
+        },
+    };
+    const QString apList = QString::fromUtf8(QJsonDocument(aps).toJson(QJsonDocument::Compact));
+
+    // 单个设备的 AP 列表与其它数据一样经由快照更新, 不同设备的相同数据不会被跳过
+    for (const QString &devPath : { QString("/org/freedesktop/NetworkManager/Devices/1"), QString("/org/freedesktop/NetworkManager/Devices/3") }) {
+        const quint64 generation = obj->generation();
+        QMetaObject::invokeMethod(obj, "onDeviceAPListChanged", Q_ARG(QString, devPath), Q_ARG(QString, apList));
+        EXPECT_GT(obj->generation(), generation);
+        EXPECT_EQ(obj->snapshot()->accessPoints(devPath).size(), 1);
+    }
+
+    for (NetworkDevice *dev : obj->devices()) {
+        if (dev->type() == NetworkDevice::Wireless)
+            EXPECT_EQ(static_cast<WirelessDevice *>(dev)->apList().size(), 1);
+    }
+}
+
+TEST_F(TstNetworkModel, snapshotGeneration)
+{
+    const quint64 generation = obj->generation();
+    const NetworkSnapshotPtr before = obj->snapshot();
+
+    QMetaObject::invokeMethod(obj, "onConnectionListChanged", Q_ARG(QString, syntheticConnections(5)));
+
+    const NetworkSnapshotPtr after = obj->snapshot();
+    EXPECT_GT(obj->generation(), generation);
+    EXPECT_EQ(after->generation(), obj->generation());
+    EXPECT_EQ(after->wireless().size(), 5);
+    // 已发布的快照不会被修改
+    EXPECT_TRUE(before->wireless().isEmpty());
+
+    // 内容相同的数据不会产生新的快照
+    QMetaObject::invokeMethod(obj, "onConnectionListChanged", Q_ARG(QString, syntheticConnections(5)));
+    EXPECT_EQ(obj->snapshot(), after);
+}
+
+TEST_F(TstNetworkModel, deviceLoopBenchmark)
+{
+    const int deviceCount = 32;
+    const int rounds = 200;
+
+    QMetaObject::invokeMethod(obj, "onDevicesChanged", Q_ARG(QString, syntheticDevices(deviceCount)));
+    ASSERT_EQ(obj->devices().size(), deviceCount);
+    EXPECT_EQ(obj->devices().first()->usingHwAdr(), obj->devices().first()->info().value("ClonedAddress").toString());
+
+    // 每轮的连接列表都不同, 每次都会重新按设备划分连接
+    QElapsedTimer timer;
+    timer.start();
+    for (int round = 0; round < rounds; ++round)
+        QMetaObject::invokeMethod(obj, "onConnectionListChanged", Q_ARG(QString, syntheticConnections(50 + round % 2)));
+    const qint64 partitionNs = timer.nsecsElapsed();
+
+    // 模拟 model 中按路径查找设备及划分连接时对设备字段的读取
+    int matched = 0;
+    timer.restart();
+    for (int round = 0; round < rounds; ++round) {
+        for (NetworkDevice *dev : obj->devices()) {
+            if (!dev->path().isEmpty() && !dev->usingHwAdr().isEmpty() && !dev->realHwAdr().isEmpty())
+                ++matched;
+        }
+    }
+    const qint64 cachedNs = timer.nsecsElapsed();
+
+    // 对照: 每次读取都查找 json
+    int jsonMatched = 0;
+    timer.restart();
+    for (int round = 0; round < rounds; ++round) {
+        for (NetworkDevice *dev : obj->devices()) {
+            const QJsonObject &info = dev->info();
+            const QString &cloned = info.value("ClonedAddress").toString();
+            const QString &hw = info.value("HwAddress").toString();
+            if (!info.value("Path").toString().isEmpty() && !(cloned.isEmpty() ? hw : cloned).isEmpty() && !hw.isEmpty())
+                ++jsonMatched;
+        }
+    }
+    const qint64 jsonNs = timer.nsecsElapsed();
+
+    EXPECT_EQ(matched, deviceCount * rounds);
+    EXPECT_EQ(jsonMatched, deviceCount * rounds);
+    EXPECT_EQ(obj->wireless().size(), 50 + (rounds - 1) % 2);
+
+    // 缓存的设备字段与 json 中的值一致
+    for (NetworkDevice *dev : obj->devices()) {
+        const QJsonObject &info = dev->info();
+        const QString &cloned = info.value("ClonedAddress").toString();
+        const QString &hw = info.value("HwAddress").toString();
+        EXPECT_EQ(dev->path(), info.value("Path").toString());
+        EXPECT_EQ(dev->realHwAdr(), hw);
+        EXPECT_EQ(dev->usingHwAdr(), cloned.isEmpty() ? hw : cloned);
+    }
+
+    reportBenchmark("connectionPartitioning", partitionNs / 1000000, "ms");
+    reportBenchmark("cachedFieldReads", cachedNs / 1000, "us");
+    reportBenchmark("jsonFieldReads", jsonNs / 1000, "us");
+}
+
+TEST_F(TstNetworkModel, deviceTypeChanged)
+{
+    QJsonObject dev {
+        {"Path", "/org/freedesktop/NetworkManager/Devices/1"},
+        {"Interface", "wlan0"},
+        {"HwAddress", "00:11:22:33:44:55"},
+    };
+    QMetaObject::invokeMethod(obj, "onDevicesChanged", Q_ARG(QString, QString::fromUtf8(
+            QJsonDocument(QJsonObject {{"wireless", QJsonArray {dev}}}).toJson(QJsonDocument::Compact))));
+    ASSERT_EQ(obj->devices().size(), 1);
+    ASSERT_EQ(obj->devices().first()->type(), NetworkDevice::Wireless);
+
+    // 同一个路径被分配给了有线网卡(例如缓存中的设备在重启后路径被重新分配), 需要重新创建设备
+    dev.insert("Interface", "eth0");
+    QMetaObject::invokeMethod(obj, "onDevicesChanged", Q_ARG(QString, QString::fromUtf8(
+            QJsonDocument(QJsonObject {{"wired", QJsonArray {dev}}}).toJson(QJsonDocument::Compact))));
+    ASSERT_EQ(obj->devices().size(), 1);
+    EXPECT_EQ(obj->devices().first()->type(), NetworkDevice::Wired);
+    EXPECT_EQ(obj->devices().first()->interfaceName(), QString("eth0"));
+}
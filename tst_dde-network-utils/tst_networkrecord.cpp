@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include "networkrecord.h"
+#include "testdata.h"
+#include "benchmark.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVector>
+
+#include <malloc.h>
+
+using namespace dde::network;
+
+TEST(TstNetworkRecord, parseConnection)
+{
+    const QJsonObject conn {
+        {"Uuid", "uuid-1"},
+        {"Id", "office"},
+        {"Path", "/org/freedesktop/NetworkManager/Settings/1"},
+        {"Ssid", "office"},
+        {"HwAddress", "00:11:22:33:44:55"},
+    };
+
+    const ConnectionRecord &record = ConnectionRecord::fromJson(conn, "wireless");
+    EXPECT_TRUE(record.isValid());
+    EXPECT_EQ(record.uuid, QString("uuid-1"));
+    EXPECT_EQ(record.ssid, QString("office"));
+    EXPECT_EQ(record.type, WirelessConnection);
+    EXPECT_EQ(ConnectionRecord::parseType("vpn-openvpn"), VpnConnection);
+    EXPECT_EQ(ConnectionRecord::parseType("bond"), UnknownConnection);
+}
+
+TEST(TstNetworkRecord, parseAccessPoint)
+{
+    const QJsonObject ap {
+        {"Path", "/org/freedesktop/NetworkManager/AccessPoint/1"},
+        {"Ssid", "office"},
+        {"Strength", 64},
+        {"Secured", true},
+        {"Frequency", 5180},
+    };
+
+    const AccessPointRecord &record = AccessPointRecord::fromJson(ap);
+    EXPECT_TRUE(record.isValid());
+    EXPECT_EQ(record.strength, 64);
+    EXPECT_TRUE(record.secured);
+    EXPECT_EQ(record.frequency, 5180);
+}
+
+TEST(TstNetworkRecord, internString)
+{
+    const QString a = internString(QString("shared-ssid"));
+    const QString b = internString(QString("shared-ssid"));
+
+    EXPECT_EQ(a, b);
+    EXPECT_TRUE(a.isSharedWith(b));
+}
+
+// 当前进程在堆上已分配的字节数
+static qint64 heapBytes()
+{
+#if __GLIBC_PREREQ(2, 33)
+    return qint64(mallinfo2().uordblks);
+#else
+    return qint64(mallinfo().uordblks);
+#endif
+}
+
+TEST(TstNetworkRecord, memoryFootprint)
+{
+    const int connCount = 1000;
+    const int apCount = 300;
+    const QByteArray conns = syntheticConnections(connCount).toUtf8();
+    const QByteArray aps = syntheticAccessPointsPayload("/org/freedesktop/NetworkManager/Devices/1", apCount).toUtf8();
+
+    // 类型化的记录, 解析用的 json 文档在作用域结束时释放
+    qint64 heap = heapBytes();
+    QVector<ConnectionRecord> connRecords;
+    QVector<AccessPointRecord> apRecords;
+    {
+        for (const QJsonValue &conn : QJsonDocument::fromJson(conns).object().value("wireless").toArray())
+            connRecords.append(ConnectionRecord::fromJson(conn.toObject(), "wireless"));
+        for (const QJsonValue &ap : QJsonDocument::fromJson(aps).object().constBegin().value().toArray())
+            apRecords.append(AccessPointRecord::fromJson(ap.toObject()));
+    }
+    const qint64 recordBytes = heapBytes() - heap;
+
+    // 以前的存储方式: 每个实体都是一个 QJsonObject
+    heap = heapBytes();
+    QList<QJsonObject> connObjects;
+    QList<QJsonObject> apObjects;
+    for (const QJsonValue &conn : QJsonDocument::fromJson(conns).object().value("wireless").toArray())
+        connObjects.append(conn.toObject());
+    for (const QJsonValue &ap : QJsonDocument::fromJson(aps).object().constBegin().value().toArray())
+        apObjects.append(ap.toObject());
+    const qint64 jsonBytes = heapBytes() - heap;
+
+    ASSERT_EQ(connRecords.size(), connCount);
+    ASSERT_EQ(apRecords.size(), apCount);
+    EXPECT_EQ(connObjects.size(), connCount);
+    EXPECT_EQ(apObjects.size(), apCount);
+    EXPECT_EQ(connRecords.last().uuid, connObjects.last().value("Uuid").toString());
+
+    reportBenchmark("jsonStorage", jsonBytes / 1024, "KB");
+    reportBenchmark("recordStorage", recordBytes / 1024, "KB");
+}
@@ -1,8 +1,19 @@
 #include <gtest/gtest.h>
 
 #include "networkworker.h"
+#include "wirelessdevice.h"
+#include "wirelessscanscheduler.h"
+#include "testdata.h"
+#include "benchmark.h"
 
 #include <QMimeData>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QProcess>
+#include <QTimer>
+#include <QDBusMessage>
+#include <QDBusObjectPath>
 
 using namespace dde::network;
 
@@ -28,3 +39,148 @@ TEST_F(TstNetworkWorker, coverageTest)
 {
 
 }
+
+TEST_F(TstNetworkWorker, startupPipeline)
+{
+    NetworkModel model(nullptr, false);
+
+    QElapsedTimer timer;
+    timer.start();
+    NetworkWorker worker(&model);
+
+    // 初始数据全部异步获取, 构造时不会阻塞
+    const qint64 constructMs = timer.elapsed();
+
+    // 后端不存在时 GetAll 会失败, 重试几次后改为逐个读取属性, 之后同样需要完成初始化.
+    // 失败的结果在事件循环中才会返回, 此时缩短重试间隔对第一次重试同样有效
+    worker.setInitRetryInterval(10);
+
+    QEventLoop loop;
+    QObject::connect(&worker, &NetworkWorker::initialized, &loop, &QEventLoop::quit);
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+    if (!worker.isInitialized())
+        loop.exec();
+
+    ASSERT_TRUE(worker.isInitialized());
+    reportBenchmark("workerConstruction", constructMs, "ms");
+    reportBenchmark("timeToCompleteModel", worker.initializeTime(), "ms");
+}
+
+TEST_F(TstNetworkWorker, activeLatencyBenchmark)
+{
+    NetworkModel model(nullptr, false);
+    NetworkWorker worker(&model);
+
+    EXPECT_EQ(model.appProxyExist(), QFileInfo::exists("/usr/bin/proxychains4"));
+
+    const int rounds = 100;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < rounds; ++i)
+        worker.active();
+    const qint64 activeNs = timer.nsecsElapsed() / rounds;
+
+    // 对照: 原来每次 active() 都会启动一个 which 进程
+    timer.restart();
+    QProcess::execute("which", QStringList() << "/usr/bin/proxychains4");
+    const qint64 processNs = timer.nsecsElapsed();
+
+    EXPECT_EQ(model.appProxyExist(), QFileInfo::exists("/usr/bin/proxychains4"));
+    reportBenchmark("activeAverage", activeNs / 1000, "us");
+    reportBenchmark("whichSubprocess", processNs / 1000, "us");
+}
+
+// 运行事件循环 msec 毫秒
+static void processEvents(int msec)
+{
+    QEventLoop loop;
+    QTimer::singleShot(msec, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+TEST_F(TstNetworkWorker, scanRequests)
+{
+    NetworkModel model(nullptr, false);
+    NetworkWorker worker(&model);
+    // 只观察请求发起的扫描
+    worker.deactive();
+
+    WirelessScanScheduler *scheduler = worker.scanScheduler();
+    scheduler->setMinInterval(500);
+    scheduler->setMaxInterval(4000);
+    int scans = 0;
+    QObject::connect(scheduler, &WirelessScanScheduler::scanRequested, [&] { ++scans; });
+
+    // 多个界面同时请求只扫描一次
+    worker.requestWirelessScan();
+    worker.requestWirelessScan();
+    processEvents(250);
+    EXPECT_EQ(scans, 1);
+
+    // 界面的请求与上一次扫描至少间隔最小间隔
+    worker.requestWirelessScan();
+    processEvents(100);
+    EXPECT_EQ(scans, 1);
+    processEvents(400);
+    EXPECT_EQ(scans, 2);
+
+    // 设备发起的请求按退避的间隔执行
+    scheduler->onScanFinished();
+    ASSERT_EQ(scheduler->currentInterval(), 1000);
+    Q_EMIT model.requestWirelessScan();
+    processEvents(600);
+    EXPECT_EQ(scans, 2);
+    processEvents(600);
+    EXPECT_EQ(scans, 3);
+}
+
+TEST_F(TstNetworkWorker, roamingScan)
+{
+    NetworkModel model(nullptr, false);
+    NetworkWorker worker(&model);
+    worker.deactive();
+
+    WirelessScanScheduler *scheduler = worker.scanScheduler();
+    scheduler->setMinInterval(60 * 1000);
+    int scans = 0;
+    QObject::connect(scheduler, &WirelessScanScheduler::scanRequested, [&] { ++scans; });
+
+    QMetaObject::invokeMethod(&model, "onDevicesChanged", Q_ARG(QString, syntheticDevices(2)));
+    const QString devPath("/org/freedesktop/NetworkManager/Devices/1");
+    WirelessDevice *dev = nullptr;
+    for (NetworkDevice *d : model.devices()) {
+        if (d->path() == devPath)
+            dev = static_cast<WirelessDevice *>(d);
+    }
+    ASSERT_TRUE(dev);
+
+    // 同名网络中信号最强的 AP 变化不是漫游
+    Q_EMIT dev->activeApInfoChanged(QJsonObject {{"Path", "/ap/1"}});
+    Q_EMIT dev->activeApInfoChanged(QJsonObject {{"Path", "/ap/2"}});
+    processEvents(300);
+    EXPECT_EQ(scans, 0);
+
+    // 以 NetworkManager 中设备实际关联的 AP 判断漫游
+    auto activeApChanged = [&](const QString &apPath) {
+        const QDBusMessage &message = QDBusMessage::createSignal(devPath, "org.freedesktop.DBus.Properties", "PropertiesChanged");
+        QVariantMap changed;
+        changed.insert("ActiveAccessPoint", QVariant::fromValue(QDBusObjectPath(apPath)));
+        QMetaObject::invokeMethod(&worker, "onWirelessPropertiesChanged",
+                                  Q_ARG(QString, "org.freedesktop.NetworkManager.Device.Wireless"),
+                                  Q_ARG(QVariantMap, changed), Q_ARG(QStringList, QStringList()),
+                                  Q_ARG(QDBusMessage, message));
+    };
+
+    activeApChanged("/ap/1");
+    processEvents(300);
+    EXPECT_EQ(scans, 0);
+
+    activeApChanged("/ap/2");
+    processEvents(300);
+    EXPECT_EQ(scans, 1);
+
+    // 断开连接时同样提前扫描
+    activeApChanged("/");
+    processEvents(300);
+    EXPECT_EQ(scans, 2);
+}
@@ -1,8 +1,18 @@
 #include <gtest/gtest.h>
 
 #include "wirelessdevice.h"
+#include "testdata.h"
+#include "benchmark.h"
 
 #include <QMimeData>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QFile>
+#include <QEventLoop>
+#include <QTimer>
+
+#include <com_deepin_daemon_network.h>
 
 using namespace dde::network;
 
@@ -11,13 +21,13 @@ class TstWirelessDevice : public testing::Test
 public:
     void SetUp() override
     {
-//        obj = new WirelessDevice();
+        obj = new WirelessDevice(QJsonObject {{"Path", "/org/freedesktop/NetworkManager/Devices/1"}});
     }
 
     void TearDown() override
     {
-//        delete obj;
-//        obj = nullptr;
+        delete obj;
+        obj = nullptr;
     }
 
 public:
@@ -28,3 +38,337 @@ TEST_F(TstWirelessDevice, coverageTest)
 {
 
 }
+
+TEST_F(TstWirelessDevice, wirelessUpdateBenchmark)
+{
+    const int apCount = 300;
+    // 每 2 秒刷新一次, 共模拟一分钟
+    const int rounds = 30;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int round = 0; round < rounds; ++round) {
+        obj->WirelessUpdate(syntheticAccessPoints(apCount, round));
+        obj->apList();
+    }
+    const qint64 parsedNs = timer.nsecsElapsed();
+
+    EXPECT_EQ(obj->apList().size(), apCount);
+
+    // 旧的实现中每个 AP 都会序列化为字符串后再解析一次, apList() 还会再解析一次
+    timer.restart();
+    for (int round = 0; round < rounds; ++round) {
+        for (const QJsonValue &ap : syntheticAccessPoints(apCount, round)) {
+            const QString &str = QString(QJsonDocument(ap.toObject()).toJson());
+            QJsonDocument::fromJson(str.toUtf8());
+            QJsonDocument::fromJson(str.toUtf8());
+        }
+    }
+    const qint64 roundTripNs = timer.nsecsElapsed();
+
+    // 默认不做平滑, 对外的信号强度就是最后一次扫描的结果
+    for (const QJsonValue &ap : syntheticAccessPoints(apCount, rounds - 1)) {
+        const QJsonObject &apInfo = ap.toObject();
+        EXPECT_EQ(obj->apRecord(apInfo.value("Path").toString()).strength, apInfo.value("Strength").toInt());
+    }
+
+    reportBenchmark("wirelessUpdate", parsedNs / 1000000, "ms");
+    reportBenchmark("oldPathRoundTrips", roundTripNs / 1000000, "ms");
+}
+
+TEST_F(TstWirelessDevice, apListRemovesMissing)
+{
+    obj->setApExpiry(0);
+    obj->WirelessUpdate(syntheticAccessPoints(10, 0));
+    ASSERT_EQ(obj->apList().size(), 10);
+
+    obj->WirelessUpdate(syntheticAccessPoints(4, 0));
+    EXPECT_EQ(obj->apList().size(), 4);
+    EXPECT_EQ(obj->apRecords().size(), 4);
+}
+
+TEST_F(TstWirelessDevice, apListIgnoresEmptyPaths)
+{
+    obj->setApExpiry(0);
+    obj->WirelessUpdate(syntheticAccessPoints(3, 0));
+    ASSERT_EQ(obj->apList().size(), 3);
+
+    // 没有路径的条目不会加入列表, 也不能抵消缺失的 AP
+    QJsonArray aps = syntheticAccessPoints(2, 0);
+    aps.append(QJsonObject {{"Path", ""}, {"Strength", 50}});
+    obj->WirelessUpdate(aps);
+    EXPECT_EQ(obj->apList().size(), 2);
+    EXPECT_EQ(obj->apRecords().size(), 2);
+}
+
+TEST_F(TstWirelessDevice, unchangedApsEmitNothing)
+{
+    obj->WirelessUpdate(syntheticAccessPoints(20, 0));
+
+    int infoChanged = 0;
+    WirelessDevice::AccessPointFields lastFields;
+    QObject::connect(obj, &WirelessDevice::apInfoChanged, [&] { ++infoChanged; });
+    QObject::connect(obj, &WirelessDevice::apFieldsChanged,
+                     [&](const QJsonObject &, WirelessDevice::AccessPointFields fields) { lastFields = fields; });
+
+    // 内容相同的扫描结果不应发出任何信号
+    obj->WirelessUpdate(syntheticAccessPoints(20, 0));
+    EXPECT_EQ(infoChanged, 0);
+
+    QJsonArray aps = syntheticAccessPoints(20, 0);
+    QJsonObject ap = aps.at(5).toObject();
+    ap.insert("Strength", 100);
+    aps.replace(5, ap);
+    obj->WirelessUpdate(aps);
+    EXPECT_EQ(infoChanged, 1);
+    EXPECT_EQ(lastFields, WirelessDevice::AccessPointFields(WirelessDevice::StrengthField));
+}
+
+TEST_F(TstWirelessDevice, strongestApPerSsid)
+{
+    obj->setApExpiry(0);
+    // ssid-1 对应第 3, 4, 5 个 AP, 信号强度分别为 21, 28, 35
+    QJsonArray aps = syntheticAccessPoints(9, 0);
+    obj->WirelessUpdate(aps);
+
+    int activeChanged = 0;
+    QObject::connect(obj, &WirelessDevice::activeApInfoChanged, [&] { ++activeChanged; });
+
+    obj->setActiveApBySsid("ssid-1");
+    EXPECT_EQ(activeChanged, 1);
+    EXPECT_EQ(obj->activeApPath(), QString("/org/freedesktop/NetworkManager/AccessPoint/5"));
+
+    // 非最强 AP 的信号变化不会切换当前 AP
+    QJsonObject ap = aps.at(3).toObject();
+    ap.insert("Strength", 30);
+    aps.replace(3, ap);
+    obj->WirelessUpdate(aps);
+    EXPECT_EQ(activeChanged, 1);
+
+    ap.insert("Strength", 90);
+    aps.replace(3, ap);
+    obj->WirelessUpdate(aps);
+    EXPECT_EQ(activeChanged, 2);
+    EXPECT_EQ(obj->activeApPath(), QString("/org/freedesktop/NetworkManager/AccessPoint/3"));
+
+    // 最强的 AP 消失后在剩余的同名 AP 中重新选择
+    aps.removeAt(3);
+    obj->WirelessUpdate(aps);
+    EXPECT_EQ(activeChanged, 3);
+    EXPECT_EQ(obj->activeApPath(), QString("/org/freedesktop/NetworkManager/AccessPoint/5"));
+}
+
+TEST_F(TstWirelessDevice, groupedNetworks)
+{
+    int added = 0, changed = 0, removed = 0;
+    QObject::connect(obj, &WirelessDevice::networkAdded, [&] { ++added; });
+    QObject::connect(obj, &WirelessDevice::networkChanged, [&] { ++changed; });
+    QObject::connect(obj, &WirelessDevice::networkRemoved, [&] { ++removed; });
+    obj->setApExpiry(0);
+    obj->setStrengthSmoothing(1);
+    obj->setStrengthHysteresis(0);
+
+    // 每 3 个 AP 共用一个 SSID
+    QJsonArray aps = syntheticAccessPoints(30, 0);
+    obj->WirelessUpdate(aps);
+    ASSERT_EQ(obj->networks().size(), 10);
+    EXPECT_EQ(added, 10);
+
+    const QJsonObject network = obj->network("ssid-1");
+    EXPECT_EQ(network.value("BssidCount").toInt(), 3);
+    EXPECT_EQ(network.value("Strength").toInt(), 35);
+    EXPECT_EQ(network.value("Path").toString(), QString("/org/freedesktop/NetworkManager/AccessPoint/5"));
+
+    // 只有受影响的网络会发出信号
+    QJsonObject ap = aps.at(3).toObject();
+    ap.insert("Strength", 99);
+    aps.replace(3, ap);
+    obj->WirelessUpdate(aps);
+    EXPECT_EQ(changed, 1);
+    EXPECT_EQ(obj->network("ssid-1").value("Strength").toInt(), 99);
+    EXPECT_EQ(obj->network("ssid-1").value("Path").toString(), QString("/org/freedesktop/NetworkManager/AccessPoint/3"));
+
+    for (int i = 0; i < 3; ++i)
+        aps.removeLast();
+    obj->WirelessUpdate(aps);
+    EXPECT_EQ(removed, 1);
+    EXPECT_EQ(obj->networks().size(), 9);
+    EXPECT_EQ(added, 10);
+}
+
+TEST_F(TstWirelessDevice, rankedAccessPoints)
+{
+    obj->setStrengthSmoothing(1);
+    obj->setStrengthHysteresis(0);
+
+    QJsonArray aps = syntheticAccessPoints(10, 0);
+    obj->WirelessUpdate(aps);
+
+    const QJsonArray ranked = obj->rankedApList();
+    ASSERT_EQ(ranked.size(), 10);
+    for (int i = 1; i < ranked.size(); ++i)
+        EXPECT_GE(ranked.at(i - 1).toObject().value("Strength").toInt(), ranked.at(i).toObject().value("Strength").toInt());
+
+    int moved = 0, to = -1;
+    QObject::connect(obj, &WirelessDevice::apMoved, [&](const QJsonObject &, int, int row) { ++moved; to = row; });
+
+    QJsonObject ap = aps.at(0).toObject();
+    ap.insert("Strength", 100);
+    aps.replace(0, ap);
+    obj->WirelessUpdate(aps);
+    EXPECT_EQ(moved, 1);
+    EXPECT_EQ(to, 0);
+    EXPECT_EQ(obj->apRank(ap.value("Path").toString()), 0);
+
+    // 保存了连接的网络排在最前面
+    obj->setConnections({QJsonObject {{"Uuid", "uuid-1"}, {"Ssid", "ssid-2"}}});
+    EXPECT_EQ(obj->rankedAp(0).value("Ssid").toString(), QString("ssid-2"));
+}
+
+TEST_F(TstWirelessDevice, strengthSmoothing)
+{
+    // 默认不做平滑, 对外的信号强度与后端一致
+    EXPECT_EQ(obj->strengthSmoothing(), 1.0);
+    EXPECT_EQ(obj->strengthHysteresis(), 0);
+
+    obj->setStrengthSmoothing(0.5);
+    obj->setStrengthHysteresis(4);
+
+    const QString path("/org/freedesktop/NetworkManager/AccessPoint/0");
+    QJsonObject ap {{"Path", path}, {"Ssid", "office"}, {"Strength", 62}};
+    obj->WirelessUpdate(QJsonArray {ap});
+
+    int infoChanged = 0;
+    QObject::connect(obj, &WirelessDevice::apInfoChanged, [&] { ++infoChanged; });
+
+    // 在 62 和 64 之间来回跳动不应产生通知
+    for (int i = 0; i < 10; ++i) {
+        ap.insert("Strength", i % 2 ? 62 : 64);
+        obj->WirelessUpdate(QJsonArray {ap});
+    }
+    EXPECT_EQ(infoChanged, 0);
+    EXPECT_EQ(obj->apRecord(path).strength, 62);
+    EXPECT_EQ(obj->rawApStrength(path), 62);
+    EXPECT_EQ(obj->suppressedApUpdateCount(), quint64(10));
+
+    // 较大的变化仍然会被平滑后更新
+    ap.insert("Strength", 30);
+    obj->WirelessUpdate(QJsonArray {ap});
+    EXPECT_EQ(infoChanged, 1);
+    EXPECT_LT(obj->apRecord(path).strength, 62);
+    EXPECT_GT(obj->apRecord(path).strength, 30);
+    EXPECT_EQ(obj->rawApStrength(path), 30);
+}
+
+TEST_F(TstWirelessDevice, apUpdateInterval)
+{
+    const QString path("/org/freedesktop/NetworkManager/AccessPoint/0");
+    QJsonObject ap {{"Path", path}, {"Ssid", "office"}, {"Strength", 62}};
+    obj->WirelessUpdate(QJsonArray {ap});
+
+    int infoChanged = 0;
+    QObject::connect(obj, &WirelessDevice::apInfoChanged, [&] { ++infoChanged; });
+
+    // 窗口内的信号变化被推迟, 只保留最新的一次
+    obj->setApUpdateInterval(60 * 1000);
+    ap.insert("Strength", 40);
+    obj->WirelessUpdate(QJsonArray {ap});
+    ap.insert("Strength", 20);
+    obj->WirelessUpdate(QJsonArray {ap});
+    EXPECT_EQ(infoChanged, 0);
+    EXPECT_EQ(obj->apRecord(path).strength, 62);
+    EXPECT_EQ(obj->suppressedApUpdateCount(), quint64(2));
+
+    // 窗口结束后不需要新的数据即可得到最新的值
+    QEventLoop loop;
+    QObject::connect(obj, &WirelessDevice::apInfoChanged, &loop, &QEventLoop::quit);
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+    obj->setApUpdateInterval(10);
+    if (infoChanged == 0)
+        loop.exec();
+
+    EXPECT_EQ(infoChanged, 1);
+    EXPECT_EQ(obj->apRecord(path).strength, 20);
+    EXPECT_EQ(obj->apList().first().toObject().value("Strength").toInt(), 20);
+}
+
+// 当前进程的常驻内存(KB)
+static long residentKb()
+{
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly))
+        return 0;
+
+    return statm.readAll().split(' ').value(1).toLong() * 4;
+}
+
+TEST_F(TstWirelessDevice, constructionBenchmark)
+{
+    // 模拟有多个无线网卡的机器
+    const int count = 8;
+
+    int scanRequests = 0;
+    QObject::connect(obj, &WirelessDevice::wirelessScanRequested, [&] { ++scanRequests; });
+    obj->updateWirlessAp();
+    EXPECT_EQ(scanRequests, 1);
+
+    long rss = residentKb();
+    QElapsedTimer timer;
+    timer.start();
+    QList<WirelessDevice *> devices;
+    for (int i = 0; i < count; ++i)
+        devices << new WirelessDevice(QJsonObject {{"Path", QString("/org/freedesktop/NetworkManager/Devices/%1").arg(i + 2)}});
+    const qint64 devicesNs = timer.nsecsElapsed();
+    const long devicesKb = residentKb() - rss;
+
+    // 对照: 以前每个设备都会创建一个自己的 DBus 代理
+    rss = residentKb();
+    timer.restart();
+    QList<com::deepin::daemon::Network *> proxies;
+    for (int i = 0; i < count; ++i)
+        proxies << new com::deepin::daemon::Network("com.deepin.daemon.Network", "/com/deepin/daemon/Network", QDBusConnection::sessionBus());
+    const qint64 proxiesNs = timer.nsecsElapsed();
+    const long proxiesKb = residentKb() - rss;
+
+    // 设备自身不再创建 DBus 代理
+    for (WirelessDevice *dev : devices)
+        EXPECT_TRUE(dev->findChildren<QDBusAbstractInterface *>().isEmpty());
+
+    qDeleteAll(devices);
+    qDeleteAll(proxies);
+
+    reportBenchmark("wirelessDevicesStartup", devicesNs / 1000, "us");
+    reportBenchmark("wirelessDevicesResident", devicesKb, "KB");
+    reportBenchmark("perDeviceProxiesStartup", proxiesNs / 1000, "us");
+    reportBenchmark("perDeviceProxiesResident", proxiesKb, "KB");
+}
+
+TEST_F(TstWirelessDevice, staleApExpiry)
+{
+    obj->setApExpiry(300);
+
+    int added = 0, removed = 0;
+    QObject::connect(obj, &WirelessDevice::apAdded, [&] { ++added; });
+    QObject::connect(obj, &WirelessDevice::apRemoved, [&] { ++removed; });
+
+    obj->WirelessUpdate(syntheticAccessPoints(10, 0));
+    EXPECT_EQ(added, 10);
+
+    // 某次扫描中缺失的 AP 不会立即移除, 再次出现时也不会重复添加
+    obj->WirelessUpdate(syntheticAccessPoints(4, 0));
+    EXPECT_EQ(obj->apList().size(), 10);
+    obj->WirelessUpdate(syntheticAccessPoints(10, 0));
+    EXPECT_EQ(added, 10);
+    EXPECT_EQ(removed, 0);
+    EXPECT_GE(obj->apLastSeen("/org/freedesktop/NetworkManager/AccessPoint/9"), 0);
+
+    // 持续缺失超过过期时间后才移除
+    obj->WirelessUpdate(syntheticAccessPoints(4, 0));
+    QEventLoop loop;
+    QTimer::singleShot(1500, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    EXPECT_EQ(removed, 6);
+    EXPECT_EQ(obj->apList().size(), 4);
+    EXPECT_EQ(obj->apLastSeen("/org/freedesktop/NetworkManager/AccessPoint/9"), -1);
+}
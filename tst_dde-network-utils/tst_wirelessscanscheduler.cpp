@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include "wirelessscanscheduler.h"
+
+#include <QEventLoop>
+#include <QTimer>
+
+using namespace dde::network;
+
+class TstWirelessScanScheduler : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        obj = new WirelessScanScheduler();
+        obj->setMinInterval(200);
+        obj->setMaxInterval(800);
+    }
+
+    void TearDown() override
+    {
+        delete obj;
+        obj = nullptr;
+    }
+
+    // 运行事件循环直到发起一次扫描或超时
+    bool waitForScan(int timeout = 2000)
+    {
+        QEventLoop loop;
+        bool scanned = false;
+        QMetaObject::Connection c = QObject::connect(obj, &WirelessScanScheduler::scanRequested, [&] {
+            scanned = true;
+            loop.quit();
+        });
+        QTimer::singleShot(timeout, &loop, &QEventLoop::quit);
+        loop.exec();
+        QObject::disconnect(c);
+
+        return scanned;
+    }
+
+public:
+    WirelessScanScheduler *obj = nullptr;
+};
+
+TEST_F(TstWirelessScanScheduler, coalesceRequests)
+{
+    // 多个界面同时请求扫描只会扫描一次
+    for (int i = 0; i < 5; ++i)
+        obj->requestScan();
+
+    ASSERT_TRUE(waitForScan());
+    EXPECT_EQ(obj->requestCount(), quint64(5));
+    EXPECT_EQ(obj->scanCount(), quint64(1));
+
+    obj->onScanFinished();
+    EXPECT_GE(obj->lastScanLatency(), 0);
+    EXPECT_EQ(obj->averageScanLatency(), obj->lastScanLatency());
+
+    // 界面发起的请求不等待退避的间隔(400), 但与上一次扫描仍至少间隔最小间隔(200)
+    obj->requestScan();
+    EXPECT_FALSE(waitForScan(100));
+    EXPECT_TRUE(waitForScan(250));
+    EXPECT_EQ(obj->scanCount(), quint64(2));
+}
+
+TEST_F(TstWirelessScanScheduler, backgroundRequests)
+{
+    obj->requestScan();
+    ASSERT_TRUE(waitForScan());
+
+    // 后台请求在最小间隔内会推迟到间隔结束
+    obj->requestBackgroundScan();
+    EXPECT_FALSE(waitForScan(100));
+    EXPECT_TRUE(waitForScan());
+    EXPECT_EQ(obj->scanCount(), quint64(2));
+
+    // 已经按退避的间隔(400)推迟的后台请求不会拖延界面发起的请求
+    obj->onScanFinished();
+    obj->requestBackgroundScan();
+    obj->requestScan();
+    EXPECT_TRUE(waitForScan(300));
+    EXPECT_EQ(obj->scanCount(), quint64(3));
+}
+
+TEST_F(TstWirelessScanScheduler, periodicScan)
+{
+    // 没有无线设备时不扫描
+    obj->setPeriodicScanEnabled(true);
+    EXPECT_FALSE(waitForScan(300));
+
+    obj->onWirelessDevicesChanged(QStringList() << "/dev/1");
+    ASSERT_TRUE(waitForScan());
+
+    // 扫描完成后按退避的间隔继续扫描
+    obj->onScanFinished();
+    EXPECT_EQ(obj->currentInterval(), 400);
+    EXPECT_FALSE(waitForScan(250));
+    EXPECT_TRUE(waitForScan(400));
+
+    obj->setPeriodicScanEnabled(false);
+    obj->onScanFinished();
+    EXPECT_FALSE(waitForScan(1000));
+    EXPECT_EQ(obj->scanCount(), quint64(2));
+}
+
+TEST_F(TstWirelessScanScheduler, backoff)
+{
+    obj->requestScan();
+    ASSERT_TRUE(waitForScan());
+
+    // AP 列表没有变化时间隔逐步加倍, 直到上限
+    obj->onScanFinished();
+    EXPECT_EQ(obj->currentInterval(), 400);
+    obj->requestScan();
+    ASSERT_TRUE(waitForScan());
+    obj->onScanFinished();
+    EXPECT_EQ(obj->currentInterval(), 800);
+    obj->requestScan();
+    ASSERT_TRUE(waitForScan());
+    obj->onScanFinished();
+    EXPECT_EQ(obj->currentInterval(), 800);
+
+    obj->onAccessPointSetChanged();
+    EXPECT_EQ(obj->currentInterval(), 200);
+}
+
+TEST_F(TstWirelessScanScheduler, expediteAfterRoaming)
+{
+    obj->requestScan();
+    ASSERT_TRUE(waitForScan());
+    obj->onScanFinished();
+
+    // 首次连接不会触发扫描
+    obj->onActiveAccessPointChanged("/dev/1", "/ap/1");
+    EXPECT_FALSE(waitForScan(300));
+
+    // 漫游后立即扫描, 不等待退避的间隔
+    obj->setMinInterval(60 * 1000);
+    obj->onActiveAccessPointChanged("/dev/1", "/ap/2");
+    EXPECT_TRUE(waitForScan(1000));
+    EXPECT_EQ(obj->scanCount(), quint64(2));
+
+    // 设备移除后重新出现, 连接 AP 不是漫游
+    obj->onWirelessDevicesChanged(QStringList());
+    obj->onActiveAccessPointChanged("/dev/1", "/ap/3");
+    EXPECT_FALSE(waitForScan(300));
+}